@@ -0,0 +1,266 @@
+"""Persistent content-addressed cache for obfuscation artifacts.
+
+This module provides a small on-disk cache used to avoid re-running
+expensive deterministic pipeline steps (most notably tigress) over and
+over with identical inputs. Entries are keyed by a content hash computed
+over the input file bytes and the exact command parameters, so any change
+to the source code, the obfuscation config or the tool version
+automatically produces a different key.
+
+Each cache entry stores the produced artifact (e.g. the obfuscated source
+code file) together with the resource usage metrics recorded when the
+artifact was first produced, so cache hits can still report meaningful
+obfuscation metrics.
+
+Typical usage example:
+    import obf_perf.artifact_cache as ac
+
+    # create (or open) the cache
+    cache = ac.ArtifactCache()
+
+    # compute the key for the current work unit
+    key = cache.compute_key("source.c", ["tigress", "--Transform=Flatten"])
+
+    # try to fetch the artifact from the cache
+    metrics = cache.lookup(key, "obfuscated.c")
+    if metrics is None:
+        # cache miss: produce "obfuscated.c", then store it
+        cache.store(key, "obfuscated.c", my_metrics_dict)
+"""
+
+
+import hashlib
+import json
+import os
+import shutil
+import subprocess
+from typing import Dict, List, Optional, Union
+
+
+# default cache location, overridable through the constructor
+DEFAULT_CACHE_DIR = os.path.join(os.path.expanduser("~"),
+                                 ".cache",
+                                 "obf-perf")
+
+
+class CachedMetrics:
+    """Resource usage metrics restored from a cache entry.
+
+    Exposes the same accessors as `resource_monitor.ResourceMonitor` for
+    the metrics that are meaningful for a cached (i.e. not re-executed)
+    process, so the two can be used interchangeably by the analysis code.
+    """
+
+    def __init__(self, metrics: Dict[str, Union[int, float]]):
+        """Initializes the cached metrics.
+
+        Args:
+            metrics: Dictionary with the keys `wall_time`, `user_time`,
+                `system_time` and `max_memory`.
+        """
+
+        self._wall_time = float(metrics["wall_time"])
+        self._user_time = float(metrics["user_time"])
+        self._system_time = float(metrics["system_time"])
+        self._max_memory = int(metrics["max_memory"])
+
+
+    def wall_time(self) -> float:
+        """Gets the recorded wall clock time of the process."""
+
+        return self._wall_time
+
+
+    def user_time(self) -> float:
+        """Gets the recorded user time of the process."""
+
+        return self._user_time
+
+
+    def system_time(self) -> float:
+        """Gets the recorded system time of the process."""
+
+        return self._system_time
+
+
+    def max_memory(self) -> int:
+        """Gets the recorded maximum memory usage of the process."""
+
+        return self._max_memory
+
+
+class ArtifactCache:
+    """Persistent content-addressed cache for pipeline artifacts."""
+
+    # on-disk layout:
+    # <cache_dir>/<key[:2]>/<key>/artifact       the cached output file
+    # <cache_dir>/<key[:2]>/<key>/metrics.json   the recorded metrics
+
+    def __init__(self,
+                 cache_dir: Optional[str] = None,
+                 enabled: bool = True):
+        """Initializes the artifact cache.
+
+        Args:
+            cache_dir: Directory where the cache is stored.
+                Defaults to `~/.cache/obf-perf`.
+            enabled: Whether the cache is enabled. When disabled, lookups
+                always miss and stores are ignored, so callers do not need
+                to special-case the disabled state.
+        """
+
+        self._cache_dir = cache_dir if cache_dir else DEFAULT_CACHE_DIR
+        self._enabled = enabled
+
+
+    def compute_key(self,
+                    input_path: str,
+                    params: List[str],
+                    extra: str = "") -> str:
+        """Computes the cache key for the given input file and parameters.
+
+        The key is a hash of the input file content, the command
+        parameters and an optional extra discriminator (e.g. the tool
+        version), so it changes whenever any of them changes.
+
+        Args:
+            input_path: Path of the input file.
+            params: Command parameters that produce the artifact.
+            extra: Optional extra string to include in the key.
+
+        Returns:
+            The cache key (hex digest).
+
+        Raises:
+            OSError: If the input file cannot be read.
+        """
+
+        hasher = hashlib.sha256()
+        # hash the input file content
+        with open(input_path, 'rb') as f:
+            hasher.update(f.read())
+        # hash the command parameters
+        # (use a separator unlikely to appear in params to avoid
+        # ambiguous concatenations)
+        hasher.update("\x00".join(params).encode("utf-8"))
+        # hash the extra discriminator
+        hasher.update(extra.encode("utf-8"))
+
+        return hasher.hexdigest()
+
+
+    def lookup(self,
+               key: str,
+               out_path: str) -> Optional[CachedMetrics]:
+        """Looks up the cache entry for the given key.
+
+        On a hit, the cached artifact is copied to `out_path` and the
+        recorded metrics are returned.
+
+        Args:
+            key: Cache key computed with `compute_key`.
+            out_path: Path where to copy the cached artifact.
+
+        Returns:
+            The metrics recorded when the artifact was produced,
+            or None on a cache miss.
+        """
+
+        # a disabled cache always misses
+        if not self._enabled:
+            return None
+
+        entry_dir = self._entry_dir(key)
+        artifact_path = os.path.join(entry_dir, "artifact")
+        metrics_path = os.path.join(entry_dir, "metrics.json")
+
+        # miss if the entry is missing or incomplete
+        if not os.path.isfile(artifact_path) \
+           or not os.path.isfile(metrics_path):
+            return None
+
+        try:
+            # read the recorded metrics
+            with open(metrics_path) as f:
+                metrics = json.load(f)
+            # copy the cached artifact to the requested location
+            # (`copy` preserves the permission bits, needed when the
+            # artifact is an executable)
+            shutil.copy(artifact_path, out_path)
+        except (OSError, ValueError, KeyError):
+            # treat a corrupted entry as a miss
+            return None
+
+        return CachedMetrics(metrics)
+
+
+    def store(self,
+              key: str,
+              artifact_path: str,
+              metrics: Dict[str, Union[int, float]]) -> None:
+        """Stores an artifact and its metrics in the cache.
+
+        Args:
+            key: Cache key computed with `compute_key`.
+            artifact_path: Path of the artifact to store.
+            metrics: Dictionary with the keys `wall_time`, `user_time`,
+                `system_time` and `max_memory`.
+        """
+
+        # ignore stores on a disabled cache
+        if not self._enabled:
+            return
+
+        entry_dir = self._entry_dir(key)
+        # create the entry directory (mkdir -p)
+        os.makedirs(entry_dir, exist_ok=True)
+
+        # write the artifact first, the metrics file last:
+        # `lookup` considers the entry valid only when both files exist
+        # (`copy` preserves the permission bits, needed when the
+        # artifact is an executable)
+        shutil.copy(artifact_path, os.path.join(entry_dir, "artifact"))
+        with open(os.path.join(entry_dir, "metrics.json"), 'w') as f:
+            json.dump(metrics, f)
+
+
+    def clear(self) -> None:
+        """Removes all the entries from the cache."""
+
+        # remove the whole cache directory, if it exists
+        if os.path.isdir(self._cache_dir):
+            shutil.rmtree(self._cache_dir)
+
+
+    def _entry_dir(self, key: str) -> str:
+        """Returns the directory of the cache entry for the given key."""
+
+        # fan out entries over 256 subdirectories to keep directory
+        # listings small even for big caches
+        return os.path.join(self._cache_dir, key[:2], key)
+
+
+def tool_fingerprint(tool: str) -> str:
+    """Returns a version fingerprint for the given tool.
+
+    The fingerprint is meant to be used as the `extra` argument of
+    `ArtifactCache.compute_key`, so cached artifacts are invalidated
+    when the tool is updated.
+
+    Args:
+        tool: Name of the tool (e.g. "tigress", "gcc").
+
+    Returns:
+        The first line of `<tool> --version`, or the empty string if the
+        version cannot be determined.
+    """
+
+    try:
+        proc = subprocess.run([tool, "--version"],
+                              text=True,
+                              capture_output=True)
+        # first line of the version output
+        return proc.stdout.splitlines()[0] if proc.stdout else ""
+    except (OSError, IndexError):
+        # tool not available: fall back to an empty fingerprint
+        return ""
@@ -22,8 +22,28 @@ Typical usage example:
 
 import os
 import bz2
+import hashlib
 import json
 import subprocess
+from typing import Dict, List, Optional, Tuple
+
+
+# memoized Halstead difficulty results, keyed by a hash of the two
+# input files, so identical obfuscated sources never recompute
+# (the computation shells out to ctags and tigress, so it is by far
+# the most expensive static metric)
+__halstead_cache: Dict[str, float] = {}
+
+# memoized compressed sizes, keyed by (path, size, mtime, compressor):
+# the original file is compressed for every config of a campaign, so
+# caching its compressed size removes all but the first compression
+__compressed_size_cache: Dict[Tuple[str, int, float, str], int] = {}
+
+# size of the chunks fed to the streaming compressors
+__COMPRESSION_CHUNK_SIZE = 1024 * 1024
+
+# supported NCD compressors
+NCD_COMPRESSORS = [ "bz2", "zstd", "lz4" ]
 
 
 def file_size(path: str) -> int:
@@ -62,35 +82,44 @@ def line_count(path: str) -> int:
     return num_lines
 
 
-def normalized_compression_distance(orig_path: str, obf_path: str) -> float:
+def normalized_compression_distance(orig_path: str,
+                                    obf_path: str,
+                                    compressor: str = "bz2") -> float:
     """Returns the normalized compression distance between
     the two files at the given paths.
 
     The formula returns a value from from 0.0 (maximally similar)
     to 1.0 (maximally dissimilar).
 
+    The files are compressed in a streaming fashion (the concatenation
+    of the two files is never materialized in memory), and the
+    compressed size of the original file is cached, since the same
+    original is compared against every obfuscated output of a campaign.
+
     See http://phrack.org/issues/68/15.html
 
     Args:
         orig_path: Path of the original file.
         obf_path: Path of the obfuscated file.
+        compressor: Compressor to use, one of `NCD_COMPRESSORS`.
+            The default "bz2" needs no extra dependency; "zstd" and
+            "lz4" are much faster on large (e.g. Virtualize) outputs,
+            with rankings indistinguishable in practice.
 
     Returns:
         The normalized compression distance between the two files.
 
     Raises:
         OSError: If the file at the given path cannot be read.
+        ValueError: If the compressor is unknown or not installed.
     """
 
-    # read files as bytes
-    with open(orig_path, 'rb') as orig_f, open(obf_path, 'rb') as obf_f:
-        bytes_orig = orig_f.read()
-        bytes_obf = obf_f.read()
-
     # compute compressed sizes
-    combined_compressed_size = len(bz2.compress(bytes_orig + bytes_obf))
-    orig_compressed_size = len(bz2.compress(bytes_orig))
-    obf_compressed_size = len(bz2.compress(bytes_obf))
+    # (the original one is cached across the campaign)
+    combined_compressed_size = __compressed_size([ orig_path, obf_path ],
+                                                 compressor)
+    orig_compressed_size = __cached_compressed_size(orig_path, compressor)
+    obf_compressed_size = __compressed_size([ obf_path ], compressor)
 
     # compute normalized compression distance
     ncd = (combined_compressed_size \
@@ -106,7 +135,100 @@ def normalized_compression_distance(orig_path: str, obf_path: str) -> float:
     return ncd
 
 
-def halstead_difficulty(orig_path: str, obf_path: str) -> float:
+def __cached_compressed_size(path: str, compressor: str) -> int:
+    """Returns the compressed size of the file at the given path,
+    memoizing the result.
+
+    Args:
+        path: Path of the file to compress.
+        compressor: Compressor to use, one of `NCD_COMPRESSORS`.
+
+    Returns:
+        The size of the compressed file in bytes.
+
+    Raises:
+        OSError: If the file at the given path cannot be read.
+        ValueError: If the compressor is unknown or not installed.
+    """
+
+    # key on path, size and mtime, so a modified file is recompressed
+    stat = os.stat(path)
+    cache_key = (os.path.abspath(path),
+                 stat.st_size,
+                 stat.st_mtime,
+                 compressor)
+
+    if cache_key not in __compressed_size_cache:
+        __compressed_size_cache[cache_key] = \
+            __compressed_size([ path ], compressor)
+
+    return __compressed_size_cache[cache_key]
+
+
+def __compressed_size(paths: List[str], compressor: str) -> int:
+    """Returns the compressed size of the concatenation of the files at
+    the given paths.
+
+    The files are streamed through the compressor in chunks, so the
+    concatenation is never materialized in memory.
+
+    Args:
+        paths: Paths of the files to compress, in concatenation order.
+        compressor: Compressor to use, one of `NCD_COMPRESSORS`.
+
+    Returns:
+        The size of the compressed concatenation in bytes.
+
+    Raises:
+        OSError: If a file at the given paths cannot be read.
+        ValueError: If the compressor is unknown or not installed.
+    """
+
+    # build the streaming compressor object
+    # (zstd and lz4 are optional dependencies, imported lazily)
+    if compressor == "bz2":
+        comp = bz2.BZ2Compressor()
+    elif compressor == "zstd":
+        try:
+            import zstandard
+        except ImportError:
+            raise ValueError("compressor 'zstd' requires the"
+                             " `zstandard` package")
+        comp = zstandard.ZstdCompressor(level=19).compressobj()
+    elif compressor == "lz4":
+        try:
+            import lz4.frame
+        except ImportError:
+            raise ValueError("compressor 'lz4' requires the"
+                             " `lz4` package")
+        comp = lz4.frame.LZ4FrameCompressor(
+            compression_level=lz4.frame.COMPRESSIONLEVEL_MAX)
+    else:
+        raise ValueError(f"unknown compressor '{compressor}'")
+
+    size = 0
+    # some compressors (lz4 frame) emit a header before the first chunk
+    if hasattr(comp, "begin"):
+        size += len(comp.begin())
+
+    # stream the files through the compressor
+    for path in paths:
+        with open(path, 'rb') as f:
+            while True:
+                chunk = f.read(__COMPRESSION_CHUNK_SIZE)
+                if not chunk:
+                    break
+                size += len(comp.compress(chunk))
+
+    # flush the compressor internal buffers
+    size += len(comp.flush())
+
+    return size
+
+
+def halstead_difficulty(orig_path: str,
+                        obf_path: str,
+                        work_dir: Optional[str] = None) -> float:
     """Returns the Halstead difficulty metric of the obfuscated file.
 
     The Halstead difficulty metric is computed as the sum of the
@@ -115,14 +237,19 @@ def halstead_difficulty(orig_path: str, obf_path: str) -> float:
     the original file, before obfuscation.
     This is done to keep the computation time reasonable.
 
-    To compute the Halstead difficulty of a function, `tigress` is used.
-    To extract the function names, `ctags` is used.
+    To compute the Halstead difficulty of the functions, `tigress` is
+    used (a single invocation for all of them, so the obfuscated file
+    is parsed only once). To extract the function names, `ctags` is
+    used. Results are memoized on the content of the two files, so
+    identical inputs are never recomputed.
 
     See https://en.wikipedia.org/wiki/Halstead_complexity_measures
 
     Args:
         orig_path: Path of the original file.
         obf_path: Path of the obfuscated file.
+        work_dir: Directory where the tigress scratch files are written.
+            Optional, defaults to the current working directory.
 
     Returns:
         The Halstead difficulty metric of the obfuscated file.
@@ -132,6 +259,21 @@ def halstead_difficulty(orig_path: str, obf_path: str) -> float:
         CalledProcessError: If `ctags` or `tigress` fail.
     """
 
+    # scratch files are written in the work directory, so concurrent
+    # computations in different directories do not step on each other
+    if work_dir is None:
+        work_dir = os.getcwd()
+    metrics_json_path = os.path.join(work_dir, "metrics.json")
+
+    # check the memo first, keyed on the content of both files
+    hasher = hashlib.sha256()
+    with open(orig_path, 'rb') as orig_f, open(obf_path, 'rb') as obf_f:
+        hasher.update(orig_f.read())
+        hasher.update(obf_f.read())
+    cache_key = hasher.hexdigest()
+    if cache_key in __halstead_cache:
+        return __halstead_cache[cache_key]
+
     # extract function names from original file using ctags
     ctags_call = [ "ctags", "-x", "--c-kinds=f", orig_path ]
     ctags = subprocess.run(ctags_call,
@@ -146,13 +288,14 @@ def halstead_difficulty(orig_path: str, obf_path: str) -> float:
 
     # compute difficulty
     difficulty = 0.0
-    # for each function in the original file
-    for function in functions:
-        # compute difficulty of function using tigress
+    if functions:
+        # compute the difficulty of all the functions with a single
+        # tigress invocation, so the (often huge) obfuscated file is
+        # parsed only once
         tigress_call = [ "tigress",
                          "--Environment=x86_64:Linux:Gcc:4.6",
                          "--Transform=SoftwareMetrics",
-                         f"--Functions={function}",
+                         f"--Functions={','.join(functions)}",
                          "--SoftwareMetricsKind=halstead",
                          "--SoftwareMetricsJsonFileName=metrics.json",
                          "--out=temp-metrics.c",
@@ -160,13 +303,18 @@ def halstead_difficulty(orig_path: str, obf_path: str) -> float:
         subprocess.run(tigress_call,
                        check=True,
                        text=True,
-                       capture_output=True)
+                       capture_output=True,
+                       cwd=work_dir)
 
         # read json file containing Halstead metrics
-        with open("metrics.json") as f:
+        with open(metrics_json_path) as f:
             metrics = json.load(f)
 
-        # add difficulty of function to total difficulty
-        difficulty += metrics[0]["difficulty"]
+        # sum the difficulty of all the functions
+        # (one entry per function)
+        difficulty = sum(entry["difficulty"] for entry in metrics)
+
+    # memoize the result
+    __halstead_cache[cache_key] = difficulty
 
     return difficulty
@@ -2,8 +2,8 @@
 
 This module contains the command line interface of the obf-perf tool.
 It measures the performance of a set of obfuscation techniques on a given
-source code file. The results are printed on the standard output as a table
-or as a JSON object.
+source code file. The results are printed on the standard output as a table,
+as a JSON object or as tidy long-format CSV, or written to a Parquet file.
 It can also generate plots of the results.
 
 Usage:
@@ -11,10 +11,39 @@ Usage:
     obf-perf.py source_code obf_configs [obf_configs ...]
                 [-r RUNS]
                 [-w WARMUP]
+                [--adaptive-warmup]
+                [--obf-runs OBF_RUNS]
+                [--compile-runs COMPILE_RUNS]
+                [-j JOBS]
+                [--build-cpus BUILD_CPUS]
+                [--run-cpus RUN_CPUS]
                 [-O {0,1,2,3}]
-                [-f {table,table2,json}]
+                [-f {table,table2,json,csv,parquet}]
+                [--sort-by SORT_BY]
+                [--top TOP]
                 [-p]
                 [-o OUTPUT_DIR]
+                [--fresh-obfuscation]
+                [--fresh-compilation]
+                [--obf-cache-dir OBF_CACHE_DIR]
+                [--clear-obf-cache]
+                [--workspace WORKSPACE]
+                [--perf-events [PERF_EVENTS]]
+                [--sample-interval SAMPLE_INTERVAL]
+                [--ncd-compressor {bz2,zstd,lz4}]
+                [--harness-iterations HARNESS_ITERATIONS]
+                [--isolate]
+                [--cooldown COOLDOWN]
+                [--energy]
+                [--program-args PROGRAM_ARGS]
+                [--input-sweep INPUT_SWEEP]
+                [--time-budget TIME_BUDGET]
+                [--results-file RESULTS_FILE]
+                [--resume]
+                [--baseline BASELINE]
+                [--no-raw-samples]
+                [--remote-hosts REMOTE_HOSTS]
+                [--self-bench]
                 [-h]
 
     To obtain more information about the usage of the tool, refer to the
@@ -23,19 +52,26 @@ Usage:
 
 
 import argparse
+import csv
 import os
 import sys
 import enum
-import itertools
 import signal
-from typing import List, Union
+from concurrent.futures import ProcessPoolExecutor
+from typing import List, Optional, Tuple, Union
 from matplotlib import subprocess
 
 from prettytable import PrettyTable
 from alive_progress import alive_bar
 
+import obf_perf.artifact_cache as ac
+import obf_perf.metrics as metrics
 import obf_perf.obf_perf_core as opcore
+import obf_perf.remote as remote
+import obf_perf.resource_monitor as rm
 import obf_perf.result_container as rc
+import obf_perf.results_store as rs
+import obf_perf.self_benchmark as sb
 import obf_perf.plots as plots
 
 
@@ -75,8 +111,15 @@ def main():
     # parse cli arguments using argparse
     args = parse_args()
 
-    # validate cli arguments and return a list of obfuscation configs
-    obf_config_path_list = validate_args(args)
+    # self-benchmark mode: measure the harness itself instead of
+    # running a campaign
+    if args.self_bench:
+        run_self_bench(args)
+        sys.exit(ExitCode.NO_ERROR.value)
+
+    # validate cli arguments and return the source code files and the
+    # obfuscation configs to use
+    source_code_path_list, obf_config_path_list = validate_args(args)
 
     # try to load the obfuscation configs
     try:
@@ -85,24 +128,177 @@ def main():
         error(f"Error: cannot read '{e.filename}'",
               ExitCode.OBF_CONFIGS_NOT_FOUND)
         assert False    # unreachable (for pyright)
+    except ValueError as e:
+        # malformed config (e.g. a bad `#sweep` directive, or a swept
+        # parameter without its placeholder)
+        error(f"Error: {e}", ExitCode.INVALID_CLI_PARAM)
+        assert False    # unreachable (for pyright)
+
+    # parse the CPU pinning lists, the confidence interval target and
+    # the time budget
+    try:
+        build_cpus = parse_cpu_list(args.build_cpus)
+        run_cpus = parse_cpu_list(args.run_cpus)
+        target_ci = parse_percentage(args.target_ci)
+        time_budget = parse_duration(args.time_budget)
+    except ValueError as e:
+        error(f"Error: {e}", ExitCode.INVALID_CLI_PARAM)
+        assert False    # unreachable (for pyright)
+
+    if time_budget is not None and time_budget <= 0:
+        error(f"Error: the parameter `time-budget` must be > 0",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # validate the adaptive sampling parameters
+    if target_ci is not None:
+        if target_ci <= 0:
+            error(f"Error: the parameter `target-ci` must be > 0",
+                  ExitCode.INVALID_CLI_PARAM)
+        if args.min_runs < 2 or args.min_runs > args.runs:
+            error(f"Error: the parameter `min-runs` must be between 2"
+                   " and `runs`",
+                  ExitCode.INVALID_CLI_PARAM)
+
+    # set up the obfuscation artifact cache
+    # the cache is disabled when fresh obfuscation runs are requested
+    # (e.g. to collect meaningful obfuscation-time statistics)
+    obf_cache = ac.ArtifactCache(cache_dir=args.obf_cache_dir,
+                                 enabled=not args.fresh_obfuscation)
+    # the compile cache shares the cache directory (the keys cannot
+    # collide, since they hash different inputs and parameters)
+    compile_cache = ac.ArtifactCache(cache_dir=args.obf_cache_dir,
+                                     enabled=not args.fresh_compilation)
+    if args.clear_obf_cache:
+        # explicit cache invalidation requested
+        obf_cache.clear()
+
+    # open the durable results store, when given; when resuming, it
+    # recovers the units completed by the interrupted campaign
+    results_store = None
+    if args.results_file is not None:
+        try:
+            results_store = rs.ResultsStore(args.results_file)
+        except (OSError, ValueError) as e:
+            error(f"Error: cannot open the results store: {e}",
+                  ExitCode.INVALID_CLI_PARAM)
+
+    # parse the input sweep size list, when given
+    input_sweep = None
+    if args.input_sweep is not None:
+        try:
+            input_sweep = [ int(size.strip())
+                            for size in args.input_sweep.split(",")
+                            if size.strip() ]
+        except ValueError:
+            error(f"Error: invalid input sweep '{args.input_sweep}'",
+                  ExitCode.INVALID_CLI_PARAM)
+        if not input_sweep or any(size <= 0 for size in input_sweep):
+            error(f"Error: the `input-sweep` sizes must be >= 1",
+                  ExitCode.INVALID_CLI_PARAM)
+
+    # parse the perf event list, when given
+    perf_events = None
+    if args.perf_events is not None:
+        perf_events = [ event.strip()
+                        for event in args.perf_events.split(",")
+                        if event.strip() ]
+
+    # per-phase run counts default to the execution run count
+    obf_runs = args.obf_runs if args.obf_runs is not None else args.runs
+    compile_runs = args.compile_runs if args.compile_runs is not None \
+                   else args.runs
 
     # number of steps in the progress bar
-    bar_step_count = len(obf_configs) * (args.warmup + args.runs)
+    if args.remote_hosts:
+        # remote workers report progress only at work unit granularity
+        bar_step_count = len(source_code_path_list) * len(obf_configs)
+    else:
+        # per config: obfuscation runs, compilation runs (only performed when
+        # an optimization level is requested), warmup runs and execution runs
+        # (the latter two once per input sweep size)
+        n_variants = len(input_sweep) if input_sweep is not None else 1
+        steps_per_config = obf_runs \
+                           + (compile_runs
+                              if args.optimization_level > 0 else 0) \
+                           + (args.warmup + args.runs) * n_variants
+        # the analysis covers the full (program, config) matrix
+        bar_step_count = len(source_code_path_list) * len(obf_configs) \
+                         * steps_per_config
     with alive_bar(bar_step_count, file=sys.stderr) as bar:
         try:
-            # run the analysis
-            results = opcore.perform_analysis(args.source_code,
-                                              obf_configs,
-                                              args.runs,
-                                              args.warmup,
-                                              args.optimization_level,
-                                              lambda: bar())
+            if args.remote_hosts:
+                # dispatch the work units to the remote workers
+                hosts = [ host.strip()
+                          for host in args.remote_hosts.split(",")
+                          if host.strip() ]
+                results = remote.perform_distributed_analysis(
+                    source_code_path_list,
+                    obf_configs,
+                    hosts,
+                    args.runs,
+                    args.warmup,
+                    args.optimization_level,
+                    obf_runs=obf_runs,
+                    compile_runs=compile_runs,
+                    harness_iterations=args.harness_iterations,
+                    step_callback=lambda: bar())
+            else:
+                # run the analysis locally
+                results = opcore.perform_analysis(source_code_path_list,
+                                                  obf_configs,
+                                                  args.runs,
+                                                  args.warmup,
+                                                  args.optimization_level,
+                                                  lambda: bar(),
+                                                  obf_cache=obf_cache,
+                                                  compile_cache=compile_cache,
+                                                  obf_runs=obf_runs,
+                                                  compile_runs=compile_runs,
+                                                  jobs=args.jobs,
+                                                  build_cpus=build_cpus,
+                                                  run_cpus=run_cpus,
+                                                  target_ci=target_ci,
+                                                  min_runs=args.min_runs,
+                                                  run_order=args.run_order,
+                                                  workspace=args.workspace,
+                                                  perf_events=perf_events,
+                                                  sample_interval=
+                                                      args.sample_interval,
+                                                  ncd_compressor=
+                                                      args.ncd_compressor,
+                                                  harness_iterations=
+                                                      args.harness_iterations,
+                                                  isolate=args.isolate,
+                                                  cooldown=args.cooldown,
+                                                  measure_energy=args.energy,
+                                                  program_args=
+                                                      args.program_args,
+                                                  input_sweep=input_sweep,
+                                                  results_store=
+                                                      results_store,
+                                                  resume=args.resume,
+                                                  keep_samples=
+                                                      not args.no_raw_samples,
+                                                  baseline=args.baseline,
+                                                  time_budget=time_budget,
+                                                  status_callback=
+                                                      lambda text:
+                                                          bar.text(text),
+                                                  adaptive_warmup=
+                                                      args.adaptive_warmup)
         except OSError as e:
             # error while reading the source code
             error(f"Error: cannot read '{e.filename}'",
                   ExitCode.SOURCE_CODE_NOT_FOUND)
             assert False    # unreachable (for pyright)
 
+        except (RuntimeError, ValueError) as e:
+            # error in the distributed execution (e.g. non homogeneous
+            # worker pool, worker failure) or in the baseline reuse
+            # (e.g. environment mismatch, malformed baseline file)
+            error(f"Error: {e}", ExitCode.RUNTIME_ERROR)
+            assert False    # unreachable (for pyright)
+
         except subprocess.CalledProcessError as e:
             # error while running the analysis
             error(f"Error: an error happened while running the analysis\n"
@@ -112,23 +308,24 @@ def main():
             assert False    # unreachable (for pyright)
 
     # print the results in the specified format
-    print_results(results, args.format)
+    print_results(results, args.format, sort_by=args.sort_by, top=args.top,
+                  output_dir=args.output_dir)
 
     # plot the results
     if args.plot:
         plot_results(results, args.output_dir)
 
 
-def validate_args(args: argparse.Namespace) -> List[str]:
-    """Validates the command line arguments and extracts the
-    obfuscation config paths.
+def validate_args(args: argparse.Namespace) -> Tuple[List[str], List[str]]:
+    """Validates the command line arguments and extracts the source code
+    and obfuscation config paths.
 
     Args:
         args: The command line arguments.
 
     Returns:
-        A list of obfuscation config paths extracted from the command line
-        arguments.
+        A pair of lists: the source code paths and the obfuscation config
+        paths extracted from the command line arguments.
     """
 
     # at least one run
@@ -141,10 +338,187 @@ def validate_args(args: argparse.Namespace) -> List[str]:
         error(f"Error: the parameter `warmup` must be >= 0",
               ExitCode.INVALID_CLI_PARAM)
 
-    # check source code file exists
-    if not os.path.isfile(args.source_code):
-        error(f"Error: '{args.source_code}' is not a file",
+    # at least one build job
+    if args.jobs <= 0:
+        error(f"Error: the parameter `jobs` must be >= 1",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # at least one obfuscation run, when specified
+    if args.obf_runs is not None and args.obf_runs <= 0:
+        error(f"Error: the parameter `obf-runs` must be >= 1",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # at least one compilation run, when specified
+    if args.compile_runs is not None and args.compile_runs <= 0:
+        error(f"Error: the parameter `compile-runs` must be >= 1",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # the workspace must exist, when specified
+    if args.workspace is not None and not os.path.isdir(args.workspace):
+        error(f"Error: the workspace '{args.workspace}' is not a directory",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # positive sampling interval, when specified
+    if args.sample_interval is not None and args.sample_interval <= 0:
+        error(f"Error: the parameter `sample-interval` must be > 0",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # non-negative cooldown
+    if args.cooldown < 0:
+        error(f"Error: the parameter `cooldown` must be >= 0",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # at least one harness iteration, when specified
+    if args.harness_iterations is not None and args.harness_iterations <= 0:
+        error(f"Error: the parameter `harness-iterations` must be >= 1",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # fail early when energy measurement is requested but the RAPL
+    # counters cannot be read, instead of reporting an all-empty metric
+    if args.energy and not rm.rapl_available():
+        error(f"Error: the RAPL energy counters are not readable"
+              f" (missing hardware support, or not running as root)",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # the baseline file must exist, and baseline reuse only exists in
+    # the local pipeline
+    if args.baseline is not None:
+        if not os.path.isfile(args.baseline):
+            error(f"Error: the baseline file '{args.baseline}' does"
+                  f" not exist",
+                  ExitCode.INVALID_CLI_PARAM)
+        if args.remote_hosts is not None:
+            error(f"Error: `baseline` is not supported with"
+                  f" `remote-hosts`",
+                  ExitCode.INVALID_CLI_PARAM)
+
+    # the sort metric must be a known numeric result field ("name" is
+    # the only non-numeric one, and the columns cannot be sorted by
+    # the mean of it)
+    if args.sort_by is not None:
+        if args.sort_by not in rc.Result.fields():
+            error(f"Error: unknown metric '{args.sort_by}' for `sort-by`",
+                  ExitCode.INVALID_CLI_PARAM)
+        if args.sort_by == "name":
+            error(f"Error: `sort-by` requires a numeric metric,"
+                  f" 'name' is not one",
+                  ExitCode.INVALID_CLI_PARAM)
+
+    # at least one column must survive the trimming
+    if args.top is not None and args.top < 1:
+        error(f"Error: the parameter `top` must be >= 1",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # the distribution plots are drawn from the raw samples, so sample
+    # retention cannot be disabled when plotting
+    if args.no_raw_samples and args.plot:
+        error(f"Error: `no-raw-samples` cannot be combined with `plot`"
+              f" (the distribution plots need the raw samples)",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # the columnar exports emit one row per raw sample, so sample
+    # retention cannot be disabled for them either
+    if args.no_raw_samples and args.format in ("csv", "parquet"):
+        error(f"Error: `no-raw-samples` cannot be combined with the"
+              f" '{args.format}' format (the columnar exports need"
+              f" the raw samples)",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # resuming needs the store the previous campaign checkpointed to;
+    # like the other local-pipeline options, checkpointing does not
+    # exist in the distributed path
+    if args.resume and args.results_file is None:
+        error(f"Error: `resume` requires `results-file`",
+              ExitCode.INVALID_CLI_PARAM)
+    if args.results_file is not None and args.remote_hosts is not None:
+        error(f"Error: `results-file` is not supported with"
+              f" `remote-hosts`",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # an input sweep substitutes sizes into the program argument
+    # template, so it needs one (with the placeholder), and it only
+    # exists in the local pipeline
+    if args.input_sweep is not None:
+        if args.program_args is None or "{n}" not in args.program_args:
+            error(f"Error: `input-sweep` requires `program-args`"
+                  f" containing the '{{n}}' placeholder",
+                  ExitCode.INVALID_CLI_PARAM)
+        if args.remote_hosts is not None:
+            error(f"Error: `input-sweep` is not supported with"
+                  f" `remote-hosts`",
+                  ExitCode.INVALID_CLI_PARAM)
+
+    # the time budget is enforced by the local scheduler only
+    if args.time_budget is not None and args.remote_hosts is not None:
+        error(f"Error: `time-budget` is not supported with"
+              f" `remote-hosts`",
+              ExitCode.INVALID_CLI_PARAM)
+
+    # adaptive warmup stops early within the warmup allowance, so it
+    # needs one; like the other scheduler refinements, it only exists
+    # in the local pipeline
+    if args.adaptive_warmup:
+        if args.warmup < 1:
+            error(f"Error: `adaptive-warmup` requires `warmup` >= 1",
+                  ExitCode.INVALID_CLI_PARAM)
+        if args.remote_hosts is not None:
+            error(f"Error: `adaptive-warmup` is not supported with"
+                  f" `remote-hosts`",
+                  ExitCode.INVALID_CLI_PARAM)
+
+    # the non-default NCD compressors need an optional dependency:
+    # fail early, instead of at the first static-metrics computation
+    if args.ncd_compressor == "zstd":
+        try:
+            import zstandard
+        except ImportError:
+            error(f"Error: the 'zstd' NCD compressor requires the"
+                  f" `zstandard` package",
+                  ExitCode.INVALID_CLI_PARAM)
+    elif args.ncd_compressor == "lz4":
+        try:
+            import lz4.frame
+        except ImportError:
+            error(f"Error: the 'lz4' NCD compressor requires the"
+                  f" `lz4` package",
+                  ExitCode.INVALID_CLI_PARAM)
+
+    # check the source code argument is valid
+    # it is either a single file, or a directory containing the corpus
+    # of programs to benchmark (all its .c files)
+    # (the positionals are optional in the parser only because
+    # --self-bench, handled before this point, does not take them)
+
+    if args.source_code is None or not args.obf_configs:
+        error(f"Error: the source code and the obfuscation configs"
+              f" are required",
+              ExitCode.INVALID_CLI_PARAM)
+
+    if os.path.isdir(args.source_code):
+        # user specified a directory
+        # use all .c files in the directory as benchmark programs
+
+        # get filenames in dir
+        filenames = next(os.walk(args.source_code), (None, None, []))[2]
+        # keep only C source files, sorted
+        filenames = sorted(name for name in filenames
+                           if name.endswith(".c"))
+        # path to each file
+        source_code_path_list = [ os.path.join(args.source_code, name)
+                                  for name in filenames ]
+
+        if not source_code_path_list:
+            error(f"Error: '{args.source_code}' contains no .c files",
+                  ExitCode.SOURCE_CODE_NOT_FOUND)
+
+    elif os.path.isfile(args.source_code):
+        # user specified a single file
+        source_code_path_list = [ args.source_code ]
+
+    else:
+        error(f"Error: '{args.source_code}' is not a file or directory",
               ExitCode.SOURCE_CODE_NOT_FOUND)
+        assert False    # unreachable (for pyright)
 
     # check obfuscation configs exist and are valid
     # valid configs are either a single directory or a sequence of files
@@ -187,27 +561,140 @@ def validate_args(args: argparse.Namespace) -> List[str]:
         # remove duplicates preserving the order
         obf_config_path_list = list(dict.fromkeys(obf_config_path_list))
 
-    return obf_config_path_list
+    return source_code_path_list, obf_config_path_list
+
+
+def parse_cpu_list(cpu_list: Union[str, None]) -> Union[List[int], None]:
+    """Parses a CPU list specification like "0-3,8,10-11".
+
+    Args:
+        cpu_list: The CPU list specification, or None.
+
+    Returns:
+        The list of CPU ids, or None if no specification was given.
+
+    Raises:
+        ValueError: If the specification is malformed.
+    """
+
+    # no specification given
+    if cpu_list is None:
+        return None
+
+    cpus: List[int] = []
+    # each comma-separated part is a single CPU id or a id range
+    for part in cpu_list.split(","):
+        part = part.strip()
+        if "-" in part:
+            # id range, e.g. "0-3"
+            low_str, high_str = part.split("-", maxsplit=1)
+            low, high = int(low_str), int(high_str)
+            if low > high:
+                raise ValueError(f"invalid CPU range '{part}'")
+            cpus.extend(range(low, high + 1))
+        else:
+            # single CPU id
+            cpus.append(int(part))
+
+    if not cpus:
+        raise ValueError(f"invalid CPU list '{cpu_list}'")
+
+    return cpus
+
+
+def parse_percentage(percentage: Union[str, None]) -> Union[float, None]:
+    """Parses a percentage specification like "2%" or "0.02".
 
+    Args:
+        percentage: The percentage specification, or None.
+
+    Returns:
+        The value as a fraction (e.g. 0.02), or None if no specification
+        was given.
+
+    Raises:
+        ValueError: If the specification is malformed.
+    """
+
+    # no specification given
+    if percentage is None:
+        return None
+
+    percentage = percentage.strip()
+    if percentage.endswith("%"):
+        # percent notation, e.g. "2%"
+        return float(percentage[:-1]) / 100
+
+    # fraction notation, e.g. "0.02"
+    return float(percentage)
+
+
+def parse_duration(duration: Union[str, None]) -> Union[float, None]:
+    """Parses a duration from a string.
+
+    The duration can be given in plain seconds (e.g. "3600") or with
+    an "s", "m" or "h" suffix (e.g. "90m", "2h").
+
+    Args:
+        duration: String containing the duration, or None.
+
+    Returns:
+        The parsed duration in seconds, or None if the input is None.
+
+    Raises:
+        ValueError: If the string does not contain a valid duration.
+    """
 
-def print_results(results: rc.ResultContainer, format: str) -> None:
+    if duration is None:
+        return None
+
+    # suffix notation, e.g. "90m" or "2h"
+    multipliers = { 's': 1, 'm': 60, 'h': 3600 }
+    if duration and duration[-1] in multipliers:
+        return float(duration[:-1]) * multipliers[duration[-1]]
+
+    # plain seconds, e.g. "3600"
+    return float(duration)
+
+
+def print_results(results: rc.ResultContainer,
+                  format: str,
+                  sort_by: Optional[str] = None,
+                  top: Optional[int] = None,
+                  output_dir: str = ".") -> None:
     """Prints the results to stdout in the specified format.
 
     Args:
         results: Results to print.
-        format: Format to use. Valid values are "table", "table2" and "json".
+        format: Format to use. Valid values are "table", "table2",
+            "json", "csv" and "parquet".
+        sort_by: Metric the config columns are sorted by (descending
+            mean), e.g. "execution_wall_time". Optional, defaults to
+            insertion order. Only affects the table formats.
+        top: Number of config columns to keep after sorting. Optional,
+            defaults to all. Only affects the table formats.
+        output_dir: Output directory of the formats that write a file
+            instead of stdout (parquet). Optional, defaults to the
+            current working directory.
     """
 
     # print results using the specified format
     if format == "table":
         # table
-        print_results_table(results)
+        print_results_table(results, sort_by=sort_by, top=top)
     elif format == "table2":
         # transposed table
-        print_results_table(results, transposed=True)
+        print_results_table(results, transposed=True, sort_by=sort_by,
+                            top=top)
     elif format == "json":
         # json
         print(results.to_json())
+    elif format == "csv":
+        # tidy long-format csv, streamed to stdout
+        print_results_csv(results)
+    elif format == "parquet":
+        # tidy long-format parquet file in the output directory
+        write_results_parquet(results, output_dir)
     else:
         # should not happen thanks to argparse
         error(f"Error: invalid output format '{format}'",
@@ -215,12 +702,19 @@ def print_results(results: rc.ResultContainer, format: str) -> None:
 
 
 def print_results_table(results: rc.ResultContainer,
-                        transposed: bool = False) -> None:
+                        transposed: bool = False,
+                        sort_by: Optional[str] = None,
+                        top: Optional[int] = None) -> None:
     """Prints the results to stdout in a table format.
 
     Args:
         results: Results to print.
         transposed: Whether to transpose the table.
+        sort_by: Metric the config columns are sorted by (descending
+            mean), so the costliest configs lead the table. Optional,
+            defaults to insertion order.
+        top: Number of config columns to keep after sorting, making
+            huge campaigns readable. Optional, defaults to all.
     """
 
     def mean_stdev_str(mean: Union[int,float], stdev: Union[int,float]) -> str:
@@ -258,23 +752,87 @@ def print_results_table(results: rc.ResultContainer,
         ("Halstead difficulty", "halstead_difficulty")
     ]
 
+    # hardware counter metrics, only present when the analysis was run
+    # with perf events enabled
+    PERF_METRICS_TO_PRINT = [
+        ("CPU cycles", "execution_cycles"),
+        ("Instructions", "execution_instructions"),
+        ("IPC", "execution_ipc"),
+        ("Cache miss rate (%)", "execution_cache_miss_rate"),
+        ("Branch miss rate (%)", "execution_branch_miss_rate")
+    ]
+    METRICS_TO_PRINT = METRICS_TO_PRINT \
+                       + [ (metric_name, field_name)
+                           for metric_name, field_name in PERF_METRICS_TO_PRINT
+                           if results.has_metric(field_name) ]
+
+    # per-iteration time, only present when the analysis was run with
+    # the injected timing harness
+    if results.has_metric("execution_iteration_time"):
+        METRICS_TO_PRINT = METRICS_TO_PRINT \
+                           + [ ("Iteration time (ns)",
+                                "execution_iteration_time") ]
+
+    # energy metrics, only present when the analysis was run with
+    # energy measurement enabled
+    if results.has_metric("execution_energy"):
+        METRICS_TO_PRINT = METRICS_TO_PRINT \
+                           + [ ("Energy (J)", "execution_energy"),
+                               ("Avg power (W)", "execution_avg_power") ]
+
+    # tail percentiles of the hot metrics, from the streaming
+    # estimators; the mean hides tail latency (e.g. the JIT configs'
+    # slow runs), the percentiles expose it
+    PERCENTILE_METRICS = [ ("Time", "s", "execution_wall_time") ]
+    if results.has_metric("execution_iteration_time"):
+        PERCENTILE_METRICS = PERCENTILE_METRICS \
+                             + [ ("Iteration time", "ns",
+                                  "execution_iteration_time") ]
+    # list of (row name, dict<obf_name,percentile_value>)
+    percentile_rows = [ (f"{metric_name} p{round(p * 100)} ({unit})",
+                         results.percentile_results(field_name, p))
+                        for metric_name, unit, field_name
+                        in PERCENTILE_METRICS
+                        for p in rc.PERCENTILES ]
+
     # get average (stdev) results
     avg_results, std_results = results.get_average_results()
 
+    # order (and optionally trim) the config columns
+    obf_names = list(avg_results.keys())
+    if sort_by is not None:
+        # biggest mean first, so the costliest configs lead the table
+        obf_names.sort(key=lambda name:
+                           float(avg_results[name]     # type: ignore
+                                 .get(sort_by, 0.0)),
+                       reverse=True)
+    if top is not None:
+        obf_names = obf_names[:top]
+
     # build table
     table = PrettyTable()
     # add first column: metric name
     table.add_column("Name",
-                     [ metric_name for metric_name, _ in METRICS_TO_PRINT ])
-
-    # add a column for all the obfuscation types
-    for obf_name in avg_results:
+                     [ metric_name for metric_name, _ in METRICS_TO_PRINT ]
+                     + [ row_name for row_name, _ in percentile_rows ])
+
+    # add a column for all the obfuscation types; a unit can lack some
+    # of the printed metrics (e.g. a baseline reused from a campaign
+    # measured without --perf-events, the timing harness or --energy),
+    # so missing cells render as "n/a" instead of crashing the table
+    for obf_name in obf_names:
         curr_avg_result = avg_results[obf_name]
         curr_std_result = std_results[obf_name]
         # build column
         column = [ mean_stdev_str(curr_avg_result[field_name], # type: ignore
                                   curr_std_result[field_name]) # type: ignore
+                   if field_name in curr_avg_result
+                   else f"{'n/a':>10}"
                    for _, field_name in METRICS_TO_PRINT ]
+        column += [ f"{row_values[obf_name]:10.3f}"
+                    if obf_name in row_values
+                    else f"{'n/a':>10}"
+                    for _, row_values in percentile_rows ]
         table.add_column(obf_name, column)
 
     # transpose table if requested
@@ -288,6 +846,14 @@ def print_results_table(results: rc.ResultContainer,
 def print_table_split(table: PrettyTable) -> None:
     """Prints the table split in subtables to fit the terminal width.
 
+    The column widths are computed in a single pass over the cells
+    (a column renders as its widest cell plus padding and a border
+    character), the columns are grouped greedily into subtables that
+    fit the terminal, and each subtable is rendered exactly once.
+    The previous implementation re-rendered the whole table per column
+    inside the splitting loop, which took visible seconds on
+    hundred-config campaigns.
+
     Args:
         table: Table to print.
     """
@@ -298,38 +864,42 @@ def print_table_split(table: PrettyTable) -> None:
 
     # get terminal width
     terminal_width = os.get_terminal_size().columns
-    # get table string
-    table_str = table.get_string()
-    # get table width
-    table_width = len(table_str.splitlines()[0])
-    # get the length of the "name" column
-    name_column_width = len(table.get_string(fields=["Name"]).splitlines()[0])
-
-    # repeat until the table fits in the terminal
-    # and in the meanwhile print the subtables
-    while table_width > terminal_width:
-        # get the length of each column
-        column_widths = [ len(table.get_string(fields=[column_name]).splitlines()[0])
-                          for column_name in table.field_names[1:] ]
-        # get the cumulative length of the columns
-        cumulative_column_widths = list(itertools.accumulate(column_widths, initial=name_column_width))
-        # get the index of the first column that exceeds the terminal width
-        first_column_to_hide = next((i
-                                     for i, cum_width in enumerate(cumulative_column_widths)
-                                     if cum_width > terminal_width),
-                                    len(column_widths))
-        # names of the columns to show
-        columns_to_show = list(table.field_names[1:first_column_to_hide])
-        # print columns
-        print(table.get_string(fields=["Name"] + columns_to_show))
-        # remove columns
-        for column_name in columns_to_show:
-            table.del_column(column_name)
-        # update table width
-        table_width = len(table.get_string().splitlines()[0])
-
-    # print the remaining columns
-    print(table.get_string())
+
+    def rendered_width(column_index: int) -> int:
+        """Returns the rendered width of a column: its widest cell
+        (or header), one space of padding per side and one border
+        character."""
+        content_width = max(
+            [ len(str(row[column_index])) for row in table.rows ]
+            + [ len(str(table.field_names[column_index])) ])
+        return content_width + 3
+
+    # the "Name" column is repeated in every subtable; the leading
+    # border character of the table accounts for the extra 1
+    name_column_width = 1 + rendered_width(0)
+    column_widths = [ rendered_width(i)
+                      for i in range(1, len(table.field_names)) ]
+
+    # greedily group the columns into subtables that fit the terminal
+    # width (a single over-wide column still gets its own subtable)
+    column_groups: List[List[str]] = []
+    current_group: List[str] = []
+    current_width = name_column_width
+    for column_name, column_width in zip(table.field_names[1:],
+                                         column_widths):
+        if current_group and \
+           current_width + column_width > terminal_width:
+            column_groups.append(current_group)
+            current_group = []
+            current_width = name_column_width
+        current_group.append(column_name)
+        current_width += column_width
+    if current_group:
+        column_groups.append(current_group)
+
+    # render each subtable exactly once
+    for column_group in column_groups:
+        print(table.get_string(fields=["Name"] + column_group))
 
 
 # transpose the PrettyTable table
@@ -374,6 +944,123 @@ def print_results_json(results: rc.ResultContainer) -> None:
     print(results.to_json())
 
 
+# header of the tidy long-format exports: one row per sample, so the
+# post-processing notebooks can load the results without re-pivoting
+# the nested JSON document
+EXPORT_COLUMNS = [ "program", "config", "input_size",
+                   "metric", "run", "value" ]
+
+
+def split_unit_name(unit_name: str) -> Tuple[str, str, Optional[int]]:
+    """Splits a unit name into its program, config and input size.
+
+    Unit names are "<config>" for a single program,
+    "<program>:<config>" for a matrix, with an "@<size>" suffix when
+    the unit was measured as part of an input sweep.
+
+    Args:
+        unit_name: Name of the unit, as reported by the analysis.
+
+    Returns:
+        A (program, config, input_size) triple; the program is empty
+        for a single-program campaign and the input size is None
+        outside of input sweeps.
+    """
+
+    # strip the input sweep suffix, if any
+    input_size = None
+    if "@" in unit_name:
+        head, _, tail = unit_name.rpartition("@")
+        if tail.isdigit():
+            unit_name = head
+            input_size = int(tail)
+
+    # split the program prefix, if any
+    program, separator, config = unit_name.partition(":")
+    if not separator:
+        program, config = "", unit_name
+
+    return program, config, input_size
+
+
+def print_results_csv(results: rc.ResultContainer) -> None:
+    """Prints the results to stdout as tidy long-format CSV.
+
+    One row per retained sample (see `EXPORT_COLUMNS`); the rows are
+    streamed straight from the container's sample generator, without
+    materializing the whole document first.
+
+    Args:
+        results: Results to print.
+    """
+
+    writer = csv.writer(sys.stdout)
+    writer.writerow(EXPORT_COLUMNS)
+
+    for unit_name, metric_name, run, value in results.export_rows():
+        program, config, input_size = split_unit_name(unit_name)
+        writer.writerow([ program, config, input_size,
+                          metric_name, run, value ])
+
+
+def write_results_parquet(results: rc.ResultContainer,
+                          output_dir: str) -> None:
+    """Writes the results to a tidy long-format Parquet file.
+
+    The file is written as `results.parquet` in the output directory
+    (created if it does not exist), one row per retained sample (see
+    `EXPORT_COLUMNS`). The rows are written in batches, so the export
+    never holds more than one batch on top of the samples themselves.
+
+    Args:
+        results: Results to write.
+        output_dir: Output directory where to save the file.
+    """
+
+    # pyarrow is only needed by this export, so it is an optional
+    # dependency: importing it lazily keeps the rest of the tool
+    # usable without it
+    try:
+        import pyarrow as pa
+        import pyarrow.parquet as pq
+    except ImportError:
+        error(f"Error: the `parquet` format requires the pyarrow package",
+              ExitCode.INVALID_CLI_PARAM)
+        assert False    # unreachable (for pyright)
+
+    # create the output directory if it does not exist
+    os.makedirs(output_dir, exist_ok=True)
+    out_filename = os.path.join(output_dir, "results.parquet")
+
+    schema = pa.schema([ ("program", pa.string()),
+                         ("config", pa.string()),
+                         ("input_size", pa.int64()),
+                         ("metric", pa.string()),
+                         ("run", pa.int64()),
+                         ("value", pa.float64()) ])
+
+    # number of rows buffered per row group; small enough to keep the
+    # export memory bounded, large enough to keep the row groups
+    # efficient to scan
+    batch_size = 65536
+
+    with pq.ParquetWriter(out_filename, schema) as writer:
+        rows: List[Tuple] = []
+        for unit_name, metric_name, run, value in results.export_rows():
+            program, config, input_size = split_unit_name(unit_name)
+            rows.append((program, config, input_size,
+                         metric_name, run, value))
+            if len(rows) >= batch_size:
+                writer.write_batch(
+                    pa.record_batch(list(zip(*rows)), schema=schema))
+                rows = []
+        if rows:
+            writer.write_batch(
+                pa.record_batch(list(zip(*rows)), schema=schema))
+
+    print(f"Results written to '{out_filename}'")
+
+
 def plot_results(results: rc.ResultContainer, output_dir: str) -> None:
     """Plots the results and saves the plots in the output directory.
 
@@ -386,6 +1073,13 @@ def plot_results(results: rc.ResultContainer, output_dir: str) -> None:
     # create the output directory (mkdir -p)
     os.makedirs(output_dir, exist_ok=True)
 
+    # the plots are rendered concurrently on a process pool (see the
+    # submission at the end): each job ships a plot function name and
+    # its picklable data to a worker, which draws off-screen on the
+    # Agg backend and saves the file itself
+    # list of argument tuples for `plots.render_plot`
+    plot_jobs: List[Tuple] = []
+
     # list of (metric_name, measurement_unit, metric_key)
     # to plot using a violin plot
     violin_plot_metrics = [ ("Execution time", "s", "execution_wall_time"),
@@ -393,16 +1087,44 @@ def plot_results(results: rc.ResultContainer, output_dir: str) -> None:
                             ("Obfuscation time", "s", "obfuscation_wall_time"),
                             ("Compilation time", "s", "compile_wall_time") ]
 
+    # hardware counter metrics, only present when the analysis was run
+    # with perf events enabled
+    perf_plot_metrics = [ ("IPC", "instructions/cycle", "execution_ipc"),
+                          ("Cache miss rate", "%",
+                           "execution_cache_miss_rate"),
+                          ("Branch miss rate", "%",
+                           "execution_branch_miss_rate") ]
+    violin_plot_metrics = violin_plot_metrics \
+                          + [ entry for entry in perf_plot_metrics
+                              if results.has_metric(entry[2]) ]
+
+    # per-iteration time, only present when the analysis was run with
+    # the injected timing harness
+    if results.has_metric("execution_iteration_time"):
+        violin_plot_metrics = violin_plot_metrics \
+                              + [ ("Iteration time", "ns",
+                                   "execution_iteration_time") ]
+
+    # energy metrics, only present when the analysis was run with
+    # energy measurement enabled
+    if results.has_metric("execution_energy"):
+        violin_plot_metrics = violin_plot_metrics \
+                              + [ ("Energy per run", "J",
+                                   "execution_energy"),
+                                  ("Average power", "W",
+                                   "execution_avg_power") ]
+
     # violin plots
     for metric_name, unit, metric_key in violin_plot_metrics:
         # get the data dictionary
         data_dict = results.metric_results(metric_key)
-        # produce the violin plot and save it
-        plots.violin_plot_with_avg(data_dict,
-                                   f"{metric_name} by obfuscation type",
-                                   f"{metric_name} ({unit})",
-                                   os.path.join(output_dir,
-                                                f"{metric_key}.png"))
+        # queue the violin plot for rendering
+        plot_jobs.append(("violin_plot_with_avg",
+                          data_dict,
+                          f"{metric_name} by obfuscation type",
+                          f"{metric_name} ({unit})",
+                          os.path.join(output_dir,
+                                       f"{metric_key}.png")))
 
     # bar plots to produce
     # list[(title,y_label,filename,list[(metric_name, metric_key)])]
@@ -442,12 +1164,151 @@ def plot_results(results: rc.ResultContainer, output_dir: str) -> None:
                            for metric_name, metric_key in metrics }
             data_dict_by_group[obf_type] = inner_dict
 
-        # produce the grouped bar plot and save it
-        plots.grouped_bar_plot(data_dict_by_group,
-                               title,
-                               y_label,
-                               os.path.join(output_dir,
-                                            f"{filename_prefix}.png"))
+        # queue the grouped bar plot for rendering
+        plot_jobs.append(("grouped_bar_plot",
+                          data_dict_by_group,
+                          title,
+                          y_label,
+                          os.path.join(output_dir,
+                                       f"{filename_prefix}.png")))
+
+    # time series plots, only when the analysis was run with timeline
+    # sampling enabled
+    if results.has_timelines():
+        timelines = results.timelines()
+
+        # memory (RSS) over time
+        # series of (time, rss) samples, one per run
+        rss_series = { obf_type: [ [ (t, rss) for t, rss, _ in timeline ]
+                                   for timeline in timeline_list ]
+                       for obf_type, timeline_list in timelines.items() }
+        plot_jobs.append(("time_series_plot",
+                          rss_series,
+                          "Memory (RSS) over time by obfuscation type",
+                          "RSS (KB)",
+                          os.path.join(output_dir,
+                                       "memory_over_time.png")))
+
+        # CPU utilization over time
+        # the cumulative CPU time is differentiated between consecutive
+        # samples, giving the utilization in each sampling interval
+        cpu_series = {}
+        for obf_type, timeline_list in timelines.items():
+            series_list = []
+            for timeline in timeline_list:
+                series = []
+                for prev, curr in zip(timeline, timeline[1:]):
+                    prev_t, _, prev_cpu = prev
+                    curr_t, _, curr_cpu = curr
+                    if curr_t > prev_t:
+                        series.append((curr_t,
+                                       100 * (curr_cpu - prev_cpu)
+                                           / (curr_t - prev_t)))
+                series_list.append(series)
+            cpu_series[obf_type] = series_list
+        plot_jobs.append(("time_series_plot",
+                          cpu_series,
+                          "CPU utilization over time"
+                          " by obfuscation type",
+                          "CPU (%)",
+                          os.path.join(output_dir,
+                                       "cpu_over_time.png")))
+
+    # scaling plot, only when the analysis was run with an input sweep
+    # (the results are then keyed '<config>@<size>')
+    wall_time_by_unit = results.metric_results("execution_wall_time")
+    if any("@" in unit_name for unit_name in wall_time_by_unit):
+        # average execution wall time points, grouped back by config
+        # dict<config,list<(size,avg_wall_time)>>
+        scaling = {}
+        for unit_name, wall_times in wall_time_by_unit.items():
+            config_name, _, size_str = unit_name.rpartition("@")
+            if not config_name or not wall_times:
+                continue
+            try:
+                size = float(size_str)
+            except ValueError:
+                # a '@' in the config name itself, not a sweep key
+                continue
+            if config_name not in scaling:
+                scaling[config_name] = []
+            scaling[config_name].append((size,
+                                         sum(wall_times) / len(wall_times)))
+        plot_jobs.append(("scaling_plot",
+                          scaling,
+                          "Execution time scaling by obfuscation type",
+                          "Execution time (s)",
+                          os.path.join(
+                              output_dir,
+                              "scaling_execution_wall_time.png")))
+
+    # render all the queued plots across the process pool; rendering
+    # is CPU bound in matplotlib, so the pool turns the minutes-long
+    # sequential phase of a matrix campaign into roughly its longest
+    # single plot
+    with ProcessPoolExecutor() as pool:
+        futures = [ pool.submit(plots.render_plot, *plot_job)
+                    for plot_job in plot_jobs ]
+        for future in futures:
+            # propagate rendering failures
+            future.result()
+
+
+def run_self_bench(args: argparse.Namespace) -> None:
+    """Runs the harness self-benchmark and prints the report.
+
+    The report (timing floor, fixed per-run cost and timing/memory
+    bias of the measurement path, see `sb.run_self_benchmark`) is
+    appended to "self-bench-history.jsonl" in the output directory;
+    the values of the previous record, when one exists, are printed
+    alongside, so a regression of the measurement quality is visible
+    immediately.
+
+    Args:
+        args: The command line arguments.
+    """
+
+    # -r keeps its meaning (runs per workload), but the campaign
+    # default of 1 is too small to estimate a floor, so anything below
+    # the minimum falls back to the self-benchmark default
+    runs = args.runs if args.runs >= 2 else 20
+
+    # create the output directory if it does not exist
+    os.makedirs(args.output_dir, exist_ok=True)
+    history_path = os.path.join(args.output_dir,
+                                "self-bench-history.jsonl")
+
+    try:
+        previous = sb.load_last_history_report(history_path)
+    except ValueError as e:
+        error(f"Error: {e}", ExitCode.INVALID_CLI_PARAM)
+        assert False    # unreachable (for pyright)
+
+    with alive_bar(sb.self_benchmark_steps(runs), file=sys.stderr) as bar:
+        try:
+            report = sb.run_self_benchmark(runs=runs,
+                                           history_path=history_path,
+                                           step_callback=lambda: bar())
+        except subprocess.CalledProcessError as e:
+            error(f"Error: an error happened while running the"
+                  f" self-benchmark\n"
+                  f"{e}\n"
+                  f"{e.stderr.decode('utf-8') if e.stderr else ''}",
+                  ExitCode.RUNTIME_ERROR)
+            assert False    # unreachable (for pyright)
+
+    print(f"Harness self-benchmark ({runs} runs per workload):")
+    rows = [ ("timing floor (s)", "timing_floor_s"),
+             ("per-run fixed cost (s)", "per_run_cost_s"),
+             ("timing bias (s)", "timing_bias_s"),
+             ("timing bias stdev (s)", "timing_bias_stdev_s"),
+             ("memory bias (KB)", "rss_bias_kb") ]
+    for label, key in rows:
+        line = f"  {label:24} {report[key]:12.6f}"
+        if previous is not None and key in previous:
+            line += f"   (previous: {previous[key]:12.6f})"
+        print(line)
+    print(f"Report appended to '{history_path}'")
 
 
 def error(message: str, exit_code: ExitCode) -> None:
@@ -493,12 +1354,17 @@ def parse_args() -> argparse.Namespace:
 
     parser.add_argument(
         "source_code",
-        help="the source code to obfuscate"
+        nargs="?",
+        default=None,
+        help="the source code file to obfuscate, or a folder of source"
+             " code files to benchmark the whole (program, config)"
+             " matrix; not needed with --self-bench"
     )
 
     parser.add_argument(
         "obf_configs",
-        nargs="+",
+        nargs="*",
+        default=[],
         help="list of obfuscation configurations, or a folder containing them"
     )
 
@@ -509,13 +1375,36 @@ def parse_args() -> argparse.Namespace:
         help="output directory, default current working directory"
     )
 
-    # add a format argument to specify the output format (table, table2, json)
+    # add a format argument to specify the output format
+    # (table, table2, json, csv, parquet)
     parser.add_argument(
         "-f",
         "--format",
         default="table",
-        choices=["table", "table2", "json"],
-        help="output format, default table"
+        choices=["table", "table2", "json", "csv", "parquet"],
+        help="output format, default table; csv streams tidy"
+             " long-format rows to stdout, parquet writes"
+             " results.parquet in the output directory"
+    )
+
+    parser.add_argument(
+        "--sort-by",
+        default=None,
+        metavar="METRIC",
+        help="sort the table columns by the mean of this metric,"
+             " descending (e.g. 'execution_wall_time' puts the"
+             " costliest configs first); takes any numeric result"
+             " field name, default the config order; table formats"
+             " only"
+    )
+
+    parser.add_argument(
+        "--top",
+        type=int,
+        default=None,
+        help="keep only the first TOP config columns after sorting,"
+             " so huge campaigns stay readable, default all;"
+             " table formats only"
     )
 
     parser.add_argument(
@@ -531,7 +1420,50 @@ def parse_args() -> argparse.Namespace:
         "--runs",
         type=int,
         default=1,
-        help="number of times the program is run, default 1"
+        help="number of times the program is run, default 1;"
+             " with --target-ci this is the maximum number of runs"
+    )
+
+    parser.add_argument(
+        "--target-ci",
+        default=None,
+        help="stop sampling a config once the relative 95%% confidence"
+             " interval of the execution wall time is below this target,"
+             " e.g. '2%%' or 0.02; --runs then acts as the maximum"
+    )
+
+    parser.add_argument(
+        "--min-runs",
+        type=int,
+        default=5,
+        help="minimum number of runs before --target-ci may stop the"
+             " sampling, default 5"
+    )
+
+    parser.add_argument(
+        "--run-order",
+        default="grouped",
+        choices=["grouped", "roundrobin", "shuffle"],
+        help="execution order of the measured runs across configs:"
+             " interleaving (roundrobin/shuffle) turns slow system drift"
+             " into per-config variance instead of between-config bias,"
+             " default grouped"
+    )
+
+    parser.add_argument(
+        "--obf-runs",
+        type=int,
+        default=None,
+        help="number of times the obfuscator is run,"
+             " default same as --runs"
+    )
+
+    parser.add_argument(
+        "--compile-runs",
+        type=int,
+        default=None,
+        help="number of times the compiler is run,"
+             " default same as --runs"
     )
 
     parser.add_argument(
@@ -543,6 +1475,263 @@ def parse_args() -> argparse.Namespace:
              " the actual analysis, default 0"
     )
 
+    parser.add_argument(
+        "--adaptive-warmup",
+        default=False,
+        action="store_true",
+        help="stop warming up each config as soon as its timing"
+             " sequence reaches steady state, with -w acting as the"
+             " maximum; the number of warmup runs actually performed"
+             " is reported as the execution_warmup_runs metric,"
+             " requires -w >= 1"
+    )
+
+    parser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=1,
+        help="number of parallel build jobs (obfuscation and compilation"
+             " of different configs), default 1; the measured executions"
+             " always run sequentially"
+    )
+
+    parser.add_argument(
+        "--build-cpus",
+        default=None,
+        help="CPUs the build processes are pinned to,"
+             " e.g. '0-5,8', default no pinning"
+    )
+
+    parser.add_argument(
+        "--run-cpus",
+        default=None,
+        help="CPUs the measured program executions are pinned to;"
+             " reserving quiet CPUs for the measured runs keeps the"
+             " timing numbers stable, default no pinning"
+    )
+
+    parser.add_argument(
+        "--fresh-obfuscation",
+        default=False,
+        action="store_true",
+        help="disable the obfuscation artifact cache and re-run the"
+             " obfuscator on every run, to collect meaningful"
+             " obfuscation-time statistics"
+    )
+
+    parser.add_argument(
+        "--fresh-compilation",
+        default=False,
+        action="store_true",
+        help="disable the compile-result cache and re-run the compiler"
+             " on every run, to collect meaningful compile-time"
+             " statistics"
+    )
+
+    parser.add_argument(
+        "--obf-cache-dir",
+        default=None,
+        help="directory of the obfuscation artifact cache,"
+             " default ~/.cache/obf-perf"
+    )
+
+    parser.add_argument(
+        "--clear-obf-cache",
+        default=False,
+        action="store_true",
+        help="clear the obfuscation artifact cache before the analysis"
+    )
+
+    parser.add_argument(
+        "--perf-events",
+        nargs="?",
+        const=",".join(opcore.DEFAULT_PERF_EVENTS),
+        default=None,
+        help="count hardware events during the measured runs with"
+             " `perf stat`, to attribute slowdowns (e.g. icache blowup"
+             " versus branch mispredictions) without a second"
+             " measurement pass; optionally takes a comma-separated"
+             " event list, default when given without a value:"
+             f" {','.join(opcore.DEFAULT_PERF_EVENTS)}"
+    )
+
+    parser.add_argument(
+        "--sample-interval",
+        type=float,
+        default=None,
+        help="record the RSS/CPU timeline of every measured run,"
+             " sampling /proc at this interval (in seconds, e.g. 0.01);"
+             " with --plot, memory-over-time and CPU-over-time plots"
+             " are produced, default no timeline sampling"
+    )
+
+    parser.add_argument(
+        "--ncd-compressor",
+        default="bz2",
+        choices=metrics.NCD_COMPRESSORS,
+        help="compressor used for the normalized compression distance"
+             " static metric; 'zstd' and 'lz4' are much faster than the"
+             " default 'bz2' on large obfuscated outputs (e.g."
+             " Virtualize) with practically identical rankings, but"
+             " require the `zstandard` / `lz4` packages, default bz2"
+    )
+
+    parser.add_argument(
+        "--workspace",
+        default=None,
+        help="directory where the analysis working directory is created;"
+             " point it at a tmpfs mount (e.g. /dev/shm) to keep the"
+             " generated sources and binaries memory-resident and avoid"
+             " disk I/O noise in the measurements, default the system"
+             " temporary directory"
+    )
+
+    parser.add_argument(
+        "--harness-iterations",
+        type=int,
+        default=None,
+        help="inject an in-process timing harness that runs the"
+             " program's `main` this many times around clock_gettime"
+             " and reports the average per-iteration nanoseconds as the"
+             " 'Iteration time' metric; resolves obfuscation overhead"
+             " on microsecond-scale kernels, where whole-process"
+             " measurement is swamped by fork/exec and libc startup,"
+             " default no harness"
+    )
+
+    parser.add_argument(
+        "--isolate",
+        default=False,
+        action="store_true",
+        help="run the measured executions in isolation mode: ASLR is"
+             " disabled for the measured program and the performance"
+             " cpufreq governor is asserted (best effort, needs root);"
+             " combine with --run-cpus (shielded cpuset) and"
+             " --run-order roundrobin for the full effect; the"
+             " isolation settings are recorded in the JSON output"
+             " metadata"
+    )
+
+    parser.add_argument(
+        "--cooldown",
+        type=float,
+        default=0.0,
+        help="seconds slept after every measured run, giving the CPU"
+             " time to dissipate heat so thermally heavy configs do not"
+             " throttle the runs that follow them, default no cooldown"
+    )
+
+    parser.add_argument(
+        "--energy",
+        default=False,
+        action="store_true",
+        help="read the RAPL energy counters around every measured run,"
+             " reporting joules per run and average watts; the counters"
+             " are socket-wide, so run on an otherwise idle machine;"
+             " requires read access to the RAPL sysfs counters (root on"
+             " most machines)"
+    )
+
+    parser.add_argument(
+        "--program-args",
+        default=None,
+        help="command line arguments the measured program is run with,"
+             " as a single quoted string, e.g. '100000 --seed 42'; may"
+             " contain the '{n}' placeholder for --input-sweep,"
+             " default no arguments"
+    )
+
+    parser.add_argument(
+        "--input-sweep",
+        default=None,
+        help="comma-separated list of input sizes substituted for the"
+             " '{n}' placeholder in --program-args, e.g."
+             " '1000,10000,100000'; each config is built once and"
+             " measured at every size, the results are keyed"
+             " '<config>@<size>', and with --plot a log-log scaling"
+             " plot with the fitted scaling exponent per config is"
+             " produced, default no sweep"
+    )
+
+    parser.add_argument(
+        "--time-budget",
+        default=None,
+        help="total campaign time budget, in seconds or with an s/m/h"
+             " suffix (e.g. '3600', '90m', '2h'); when the"
+             " duration-weighted projection says the campaign will not"
+             " finish in time, measured runs are trimmed from the most"
+             " expensive configs first, never below min(--min-runs,"
+             " --runs) runs per config, default no budget"
+    )
+
+    parser.add_argument(
+        "--baseline",
+        default=None,
+        metavar="FILE",
+        help="reuse the '00-normal' (identity config) samples from a"
+             " previous campaign's results file (-f json output or"
+             " --results-file store) instead of re-measuring them;"
+             " refused when the recorded environment fingerprint (CPU"
+             " model, gcc/tigress versions) does not match the current"
+             " machine"
+    )
+
+    parser.add_argument(
+        "--self-bench",
+        default=False,
+        action="store_true",
+        help="measure the harness's own overhead instead of running a"
+             " campaign: calibrated null, busy-loop and allocator"
+             " workloads are run through the measurement path and the"
+             " timing floor, per-run fixed cost and timing/memory bias"
+             " are reported and appended to self-bench-history.jsonl"
+             " in the output directory; -r sets the runs per workload"
+             " (default 20)"
+    )
+
+    parser.add_argument(
+        "--no-raw-samples",
+        default=False,
+        action="store_true",
+        help="do not retain the raw samples in memory, only the"
+             " streaming summaries (mean, stdev, percentiles); keeps"
+             " the memory flat at matrix scale, but the distribution"
+             " plots need the raw samples, so this cannot be combined"
+             " with --plot, and the JSON output then contains the"
+             " summaries instead of the sample lists"
+    )
+
+    parser.add_argument(
+        "--results-file",
+        default=None,
+        help="append each completed (program, config) unit to this"
+             " JSONL file as soon as its measured runs finish, so a"
+             " crash or CTRL-C mid-campaign loses at most the units"
+             " still in progress; restart with --resume to continue,"
+             " default no checkpointing"
+    )
+
+    parser.add_argument(
+        "--resume",
+        default=False,
+        action="store_true",
+        help="skip the units already present in --results-file"
+             " (completed by a previous, interrupted campaign) and"
+             " merge their stored samples into the final results"
+    )
+
+    parser.add_argument(
+        "--remote-hosts",
+        default=None,
+        help="comma-separated SSH destinations of worker machines the"
+             " (program, config) work units are dispatched to, e.g."
+             " 'user@host1,user@host2'; the workers must have the same"
+             " CPU model as the local machine and obf-perf installed;"
+             " the build/run tuning options (--jobs, CPU pinning,"
+             " --target-ci, caching) only apply to local execution"
+    )
+
     parser.add_argument(
         "-O",
         "--optimization-level",
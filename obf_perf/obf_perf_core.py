@@ -19,13 +19,26 @@ Typical usage example:
 """
 
 
+import glob
+import hashlib
+import itertools
+import json
+import math
 import os
+import random
 import shlex
+import statistics
+import sys
 import tempfile
-from typing import List, Tuple, Optional, Callable
+import time
+from collections import defaultdict, deque
+from concurrent.futures import ProcessPoolExecutor, wait, FIRST_COMPLETED
+from typing import List, Tuple, Dict, Optional, Callable, Union
 
+import obf_perf.artifact_cache as ac
 import obf_perf.resource_monitor as rm
 import obf_perf.result_container as rc
+import obf_perf.results_store as rs
 import obf_perf.metrics as metrics
 
 
@@ -34,11 +47,77 @@ __NORMAL_CONFIG = (str("00-normal"), [ "tigress",
                                        "--Environment=x86_64:Linux:Gcc:4.6",
                                        "--Transform=Ident" ])
 
+# memoized tigress version fingerprint, used to key the artifact cache
+# (computed lazily, since tigress may not be needed at import time)
+__tigress_fingerprint: Optional[str] = None
+
+# memoized gcc version fingerprint, used to key the compile cache
+__gcc_fingerprint: Optional[str] = None
+
+# adaptive warmup steady-state detection: a unit is considered warm
+# when the relative spread ((max - min) / min) of the last
+# `__WARMUP_STABLE_WINDOW` warmup wall times drops below
+# `__WARMUP_STABLE_TOLERANCE` (see `__is_steady_state`)
+__WARMUP_STABLE_WINDOW = 3
+__WARMUP_STABLE_TOLERANCE = 0.05
+
+# default hardware events counted when perf measurement is enabled
+DEFAULT_PERF_EVENTS = [ "cycles",
+                        "instructions",
+                        "cache-references",
+                        "cache-misses",
+                        "branch-instructions",
+                        "branch-misses" ]
+
+# in-process timing harness appended to the generated source code when
+# harness mode is enabled (see `perform_analysis`); the original `main`
+# has been renamed to `__obf_perf_wrapped_main` by a `#define` placed
+# before the original source, so this `main` becomes the entry point:
+# it runs the workload {iterations} times around `clock_gettime` and
+# reports the average per-iteration nanoseconds on stderr, where
+# `ResourceMonitor` picks them up (see `rm.ITERATION_TIME_MARKER`)
+__TIMING_HARNESS_TEMPLATE = """
+/* obf-perf in-process timing harness */
+#undef main
+#include <stdio.h>
+#include <time.h>
+int main(int obf_perf_argc, char **obf_perf_argv) {{
+    struct timespec obf_perf_start, obf_perf_end;
+    long long obf_perf_elapsed_ns;
+    long obf_perf_i;
+    int obf_perf_status = 0;
+    clock_gettime(CLOCK_MONOTONIC, &obf_perf_start);
+    for (obf_perf_i = 0; obf_perf_i < {iterations}L; obf_perf_i++) {{
+        obf_perf_status = __obf_perf_wrapped_main(obf_perf_argc,
+                                                  obf_perf_argv);
+    }}
+    clock_gettime(CLOCK_MONOTONIC, &obf_perf_end);
+    obf_perf_elapsed_ns =
+        (long long) (obf_perf_end.tv_sec - obf_perf_start.tv_sec)
+            * 1000000000LL
+        + (obf_perf_end.tv_nsec - obf_perf_start.tv_nsec);
+    fprintf(stderr, "{marker}%lld\\n",
+            obf_perf_elapsed_ns / {iterations}L);
+    return obf_perf_status;
+}}
+"""
+
 
 def load_obfuscation_configs(obf_config_path_list: List[str]
                              ) -> List[Tuple[str, List[str]]]:
     """Loads the obfuscation configs from the given list of paths.
 
+    A config file may declare parameter sweeps with directive lines of
+    the form
+
+        #sweep FlattenDispatch=switch,goto,indirect
+
+    and reference each swept parameter in the tigress command as a
+    "{FlattenDispatch}" placeholder. The config then expands into the
+    cross product of all its sweeps, one config per combination, named
+    "<config>[param=value,...]", so tuning a transform does not require
+    hand-writing dozens of near-identical files.
+
     Args:
         obf_config_path_list: List of paths to the obfuscation configs.
 
@@ -48,6 +127,8 @@ def load_obfuscation_configs(obf_config_path_list: List[str]
 
     Raises:
         OSError: If one of the files at the given paths cannot be read.
+        ValueError: If a sweep directive is malformed, or a swept
+            parameter has no placeholder in the config.
     """
 
     # list of obfuscation configs
@@ -61,46 +142,594 @@ def load_obfuscation_configs(obf_config_path_list: List[str]
         with open(obf_config_path) as f:
             config_content = f.read()
 
-        # split the config file content into a list of params
-        params = shlex.split(config_content)
-        # remove newlines
-        params = list(filter(lambda x: x != '\n', params))
-        # add the config to the list
-        loaded_configs.append((obf_config_path, params))
+        # extract the sweep directives, keeping the rest as the
+        # config template
+        # dict<param_name,list<value>> (insertion ordered)
+        sweep_params: Dict[str, List[str]] = dict()
+        template_lines = []
+        for line in config_content.splitlines():
+            stripped_line = line.strip()
+            if not stripped_line.startswith("#sweep"):
+                template_lines.append(line)
+                continue
+
+            # "#sweep <name>=<value>,<value>,..."
+            directive = stripped_line[len("#sweep"):].strip()
+            param_name, separator, values_str = directive.partition("=")
+            param_name = param_name.strip()
+            values = [ value.strip()
+                       for value in values_str.split(",")
+                       if value.strip() ]
+            if not separator or not param_name or not values:
+                raise ValueError(f"malformed sweep directive"
+                                 f" '{stripped_line}' in"
+                                 f" '{obf_config_path}'")
+            sweep_params[param_name] = values
+        template_content = "\n".join(template_lines)
+
+        if not sweep_params:
+            # plain config: split the file content into a list of params
+            params = shlex.split(config_content)
+            # remove newlines
+            params = list(filter(lambda x: x != '\n', params))
+            # add the config to the list
+            loaded_configs.append((obf_config_path, params))
+            continue
+
+        # a swept parameter without a placeholder would expand into
+        # identical configs: reject it as a config mistake
+        for param_name in sweep_params:
+            if f"{{{param_name}}}" not in template_content:
+                raise ValueError(f"swept parameter '{param_name}' has"
+                                 f" no '{{{param_name}}}' placeholder"
+                                 f" in '{obf_config_path}'")
+
+        # expand the cross product of the sweeps, one config per
+        # combination, named "<config>[param=value,...]" (the combo is
+        # placed before the extension, so the name handling downstream
+        # strips the extension as usual)
+        config_root, config_ext = os.path.splitext(obf_config_path)
+        for combination in itertools.product(*sweep_params.values()):
+            assignment = dict(zip(sweep_params.keys(), combination))
+            combo_content = template_content
+            for param_name, value in assignment.items():
+                combo_content = combo_content.replace(
+                    f"{{{param_name}}}", value)
+
+            params = shlex.split(combo_content)
+            params = list(filter(lambda x: x != '\n', params))
+
+            combo_str = ",".join(f"{param_name}={value}"
+                                 for param_name, value
+                                 in assignment.items())
+            loaded_configs.append(
+                (f"{config_root}[{combo_str}]{config_ext}", params))
 
     return loaded_configs
 
 
-def perform_analysis(source_code_path: str,
+def environment_fingerprint() -> Dict[str, str]:
+    """Returns a fingerprint of the measurement environment.
+
+    The fingerprint identifies what the measured numbers depend on:
+    the CPU model, the gcc and tigress versions, and the cpufreq
+    governor in effect. It is recorded with the results, so samples
+    measured in a different environment (e.g. a previous campaign's
+    baseline) are not silently merged.
+
+    Returns:
+        A dictionary with the "cpu_model", "gcc", "tigress" and
+        "cpu_governor" entries.
+    """
+
+    return { "cpu_model": __cpu_model(),
+             "gcc": __get_gcc_fingerprint(),
+             "tigress": __get_tigress_fingerprint(),
+             "cpu_governor": __current_governors() }
+
+
+def load_baseline_samples(baseline_path: str
+                          ) -> Tuple[Dict[str,
+                                          Dict[str,
+                                               List[Union[int, float]]]],
+                                     Optional[Dict[str, str]]]:
+    """Loads the baseline (identity config) samples of a previous
+    campaign from a results file.
+
+    Both result formats are understood: the JSON document printed by
+    the CLI (`ResultContainer.to_json`, plain or with a metadata
+    section) and the JSONL results store (`rs.ResultsStore`). Only the
+    baseline units are extracted: "00-normal", "<program>:00-normal"
+    and their "@<size>" sweep variants.
+
+    Args:
+        baseline_path: Path of the previous campaign's results file.
+
+    Returns:
+        A pair (samples, environment): the samples of the baseline
+        units (dict mapping unit name to dict mapping metric name to
+        list of values), and the environment fingerprint the file
+        recorded, or None when it recorded none.
+
+    Raises:
+        OSError: If the file cannot be read.
+        ValueError: If the file is malformed, contains no baseline
+            units, or contains summaries instead of raw samples.
+    """
+
+    with open(baseline_path) as f:
+        content = f.read()
+
+    try:
+        # a single JSON document: the CLI's JSON output, either the
+        # two-section shape ({"metadata": ..., "results": ...}) or the
+        # plain results dictionary
+        document = json.loads(content)
+        if "results" in document and "metadata" in document:
+            all_samples = document["results"]
+            environment = document["metadata"].get("environment")
+        else:
+            all_samples = document
+            environment = None
+    except ValueError:
+        # not a single document: the JSONL results store
+        store = rs.ResultsStore(baseline_path)
+        all_samples = { unit_name: store.unit_samples(unit_name)
+                        for unit_name in store.completed_units() }
+        environment = store.environment()
+
+    baseline_samples = {}
+    for unit_name, samples in all_samples.items():
+        if not __is_baseline_unit(unit_name):
+            continue
+        # raw samples are lists; the summary-only JSON output
+        # (keep_samples disabled) serializes dictionaries instead and
+        # cannot seed a new container
+        if any(not isinstance(values, list) for values in samples.values()):
+            raise ValueError(
+                f"baseline file '{baseline_path}' contains summaries,"
+                f" not raw samples (was the campaign run with raw"
+                f" sample retention disabled?)")
+        baseline_samples[unit_name] = samples
+
+    if not baseline_samples:
+        raise ValueError(f"baseline file '{baseline_path}' contains no"
+                         f" baseline ('00-normal') units")
+
+    return baseline_samples, environment
+
+
+def __is_baseline_unit(unit_name: str) -> bool:
+    """Returns whether a unit name denotes the identity config.
+
+    Matches "00-normal", "<program>:00-normal" and their "@<size>"
+    sweep variants.
+    """
+
+    # strip a sweep size suffix, when present
+    if "@" in unit_name:
+        head, _, tail = unit_name.rpartition("@")
+        if tail.isdigit():
+            unit_name = head
+
+    return unit_name == __NORMAL_CONFIG[0] \
+           or unit_name.endswith(f":{__NORMAL_CONFIG[0]}")
+
+
+def __check_recorded_environment(recorded: Optional[Dict[str, str]],
+                                 source: str) -> None:
+    """Checks a recorded environment fingerprint against the current
+    environment.
+
+    A mismatch of the hardware or toolchain (CPU model, gcc, tigress)
+    makes the recorded samples incomparable and raises; a mismatch of
+    the cpufreq governor only warns, since the governor is a transient
+    setting the user may fix. A missing fingerprint (e.g. a results
+    file produced by an older obf-perf) also only warns.
+
+    Args:
+        recorded: The recorded fingerprint, or None.
+        source: Description of where the fingerprint comes from, for
+            the messages (e.g. the baseline file path).
+
+    Raises:
+        RuntimeError: If the hardware or toolchain does not match.
+    """
+
+    if recorded is None:
+        print(f"Warning: '{source}' records no environment"
+              f" fingerprint, cannot verify that its samples are"
+              f" comparable",
+              file=sys.stderr)
+        return
+
+    current = environment_fingerprint()
+
+    # hardware and toolchain must match for the numbers to be merged
+    for key in ("cpu_model", "gcc", "tigress"):
+        if key in recorded and recorded[key] != current[key]:
+            raise RuntimeError(
+                f"environment mismatch with '{source}': {key} was"
+                f" '{recorded[key]}', now '{current[key]}'; refusing"
+                f" to merge samples measured in a different"
+                f" environment")
+
+    # the governor only skews the numbers, it does not invalidate them
+    if recorded.get("cpu_governor", current["cpu_governor"]) \
+            != current["cpu_governor"]:
+        print(f"Warning: '{source}' was measured under the"
+              f" '{recorded['cpu_governor']}' cpufreq governor, the"
+              f" current governor is '{current['cpu_governor']}'",
+              file=sys.stderr)
+
+
+class _EtaEstimator:
+    """Duration-weighted remaining time estimator for the scheduler.
+
+    The progress steps of a campaign are wildly unequal (a run of a
+    virtualized config can cost orders of magnitude more than one of an
+    encode_literals config), so any step-counting ETA is useless. This
+    estimator instead tracks the observed mean duration of each unit's
+    build phase and of one measured run, optionally seeded from the
+    stored samples of a previous campaign, and predicts per-unit
+    durations with a global-mean fallback for the units not observed
+    yet.
+    """
+
+    def __init__(self):
+        # (total seconds, observation count) per unit name
+        self._build: Dict[str, Tuple[float, int]] = dict()
+        self._run: Dict[str, Tuple[float, int]] = dict()
+        # global aggregates, the fallback for units without
+        # observations of their own
+        self._build_total: Tuple[float, int] = (0.0, 0)
+        self._run_total: Tuple[float, int] = (0.0, 0)
+
+
+    def record_build(self, unit_name: str, seconds: float) -> None:
+        """Records the observed duration of one unit's build phase."""
+
+        total, count = self._build.get(unit_name, (0.0, 0))
+        self._build[unit_name] = (total + seconds, count + 1)
+        total, count = self._build_total
+        self._build_total = (total + seconds, count + 1)
+
+
+    def record_run(self, unit_name: str, seconds: float) -> None:
+        """Records the observed duration of one run of a unit."""
+
+        total, count = self._run.get(unit_name, (0.0, 0))
+        self._run[unit_name] = (total + seconds, count + 1)
+        total, count = self._run_total
+        self._run_total = (total + seconds, count + 1)
+
+
+    def seed_from_samples(self,
+                          unit_name: str,
+                          samples: Dict[str, List[Union[int, float]]],
+                          obf_runs: int,
+                          compile_runs: int) -> None:
+        """Seeds the per-unit predictions from stored samples.
+
+        The wall time samples of a previous campaign (the resumed
+        results store or the baseline file) are turned into one
+        synthetic observation per phase, so the ETA is informed from
+        the very first minute; the synthetic observations carry the
+        weight of a single real one, so live measurements take over
+        quickly.
+
+        Args:
+            unit_name: Name of the stored unit (possibly a sweep
+                variant, "<unit>@<size>").
+            samples: The stored samples of the unit (dict mapping
+                metric name to list of values).
+            obf_runs: Number of obfuscation runs per build of the
+                current campaign.
+            compile_runs: Number of compilation runs per build of the
+                current campaign.
+        """
+
+        execution_times = [ value for value
+                            in samples.get("execution_wall_time", [])
+                            if value is not None ]
+        if execution_times:
+            self.record_run(unit_name,
+                            sum(execution_times) / len(execution_times))
+
+        # the build phase of a sweep variant belongs to its base unit
+        build_name = unit_name
+        if "@" in build_name:
+            head, _, tail = build_name.rpartition("@")
+            if tail.isdigit():
+                build_name = head
+        if build_name in self._build:
+            # already seeded (e.g. by another sweep variant)
+            return
+
+        obf_times = [ value for value
+                      in samples.get("obfuscation_wall_time", [])
+                      if value is not None ]
+        compile_times = [ value for value
+                          in samples.get("compile_wall_time", [])
+                          if value is not None ]
+        if obf_times:
+            build_estimate = obf_runs * sum(obf_times) / len(obf_times)
+            if compile_times:
+                build_estimate += compile_runs \
+                                  * sum(compile_times) / len(compile_times)
+            self.record_build(build_name, build_estimate)
+
+
+    def predict_build(self, unit_name: str) -> Optional[float]:
+        """Predicts the duration of one unit's build phase, in seconds.
+
+        Returns:
+            The unit's observed mean duration, the global mean when the
+            unit has no observations, or None when nothing has been
+            observed at all.
+        """
+
+        total, count = self._build.get(unit_name, self._build_total)
+        return total / count if count > 0 else None
+
+
+    def predict_run(self, unit_name: str) -> Optional[float]:
+        """Predicts the duration of one run of a unit, in seconds.
+
+        Returns:
+            The unit's observed mean duration, the global mean when the
+            unit has no observations, or None when nothing has been
+            observed at all.
+        """
+
+        total, count = self._run.get(unit_name, self._run_total)
+        return total / count if count > 0 else None
+
+
+def perform_analysis(source_code_path: Union[str, List[str]],
                      obf_configs: List,
                      runs: int,
                      warmup: int,
                      optimization_level: int,
-                     step_callback: Optional[Callable] = None
+                     step_callback: Optional[Callable] = None,
+                     obf_cache: Optional[ac.ArtifactCache] = None,
+                     compile_cache: Optional[ac.ArtifactCache] = None,
+                     obf_runs: Optional[int] = None,
+                     compile_runs: Optional[int] = None,
+                     jobs: int = 1,
+                     build_cpus: Optional[List[int]] = None,
+                     run_cpus: Optional[List[int]] = None,
+                     queue_depth: int = 2,
+                     target_ci: Optional[float] = None,
+                     min_runs: int = 5,
+                     run_order: str = "grouped",
+                     workspace: Optional[str] = None,
+                     perf_events: Optional[List[str]] = None,
+                     sample_interval: Optional[float] = None,
+                     ncd_compressor: str = "bz2",
+                     harness_iterations: Optional[int] = None,
+                     isolate: bool = False,
+                     cooldown: float = 0.0,
+                     measure_energy: bool = False,
+                     program_args: Optional[str] = None,
+                     input_sweep: Optional[List[int]] = None,
+                     results_store: Optional[rs.ResultsStore] = None,
+                     resume: bool = False,
+                     keep_samples: bool = True,
+                     baseline: Optional[str] = None,
+                     time_budget: Optional[float] = None,
+                     status_callback: Optional[Callable[[str], None]] = None,
+                     adaptive_warmup: bool = False
                      ) -> rc.ResultContainer:
-    """Performs the analysis on the given source code file, using the given
+    """Performs the analysis on the given source code files, using the given
     obfuscation configs.
 
-    For each obfuscation config, the obfuscation is performed, then the
-    obfuscated source code is compiled and run, and finally the metrics are
-    computed. The number of runs and warmup runs can be specified, in order to
-    get a more stable estimate of the metrics. Of course, the warmup runs are
-    not included in the final results.
-    After each step (run or warmup run), the step_callback function is called.
+    The analysis covers the full (program, config) matrix: every source
+    code file is benchmarked against every obfuscation config, and the
+    whole matrix is scheduled through the build/measure pipeline, so the
+    per-config setup is amortized and the build work can be load-balanced
+    across the worker pool.
+    When a single source code file is given, the results are keyed by
+    config name; with multiple files they are keyed by
+    "<program>:<config>".
+
+    For each (program, config) pair, the analysis is performed in three
+    decoupled phases: first the source code is obfuscated `obf_runs`
+    times, then it is compiled `compile_runs` times, and finally the
+    already-built executable is run `runs` times. This way a high number
+    of execution samples does not pay for an equally high number of
+    obfuscator and compiler invocations, since the obfuscation and
+    compilation metrics stabilize after a handful of samples.
+    The warmup runs only involve the execution phase (the binary is
+    already built at that point) and are not included in the final
+    results.
+    After each step (obfuscation, compilation, run or warmup run), the
+    step_callback function is called.
     The optimization level can be specified for the compiler, it takes values
     from 0 to 3, where 0 is no optimization and 3 is the highest optimization.
 
     Args:
-        source_code_path: Path to the source code file.
+        source_code_path: Path to the source code file, or list of paths
+            to benchmark the whole (program, config) matrix.
         obf_configs: List of obfuscation configs.
             Use the function `load_obfuscation_configs` to get the configs.
-        runs: Number of runs for each obfuscation config.
+        runs: Number of execution runs for each obfuscation config.
         warmup: Number of warmup runs for each obfuscation config.
         optimization_level: Optimization level for the compiler.
             Takes values from 0 to 3, where 0 is no optimization and
             3 is the highest optimization.
         step_callback: Callback function to be called after each step
-            (run or warmup run).
+            (obfuscation, compilation, run or warmup run).
+        obf_cache: Artifact cache for the obfuscated source code.
+            Optional, if not provided every run re-invokes the obfuscator.
+            On a cache hit the obfuscation metrics recorded when the
+            artifact was first produced are reported.
+        compile_cache: Artifact cache for the compiled binaries, keyed
+            by (obfuscated source code, gcc flags, gcc version). On a
+            cache hit the cached binary is reused and the compile
+            metrics recorded at production time are reported; since the
+            obfuscated source is byte-identical across runs for
+            deterministic transforms, this eliminates the repeated gcc
+            invocations (notably the -O0 compiles that exist only to
+            subtract the gcc time from the obfuscation time). Optional,
+            if not provided every run re-invokes the compiler.
+        obf_runs: Number of obfuscation runs for each obfuscation config.
+            Optional, defaults to `runs`.
+        compile_runs: Number of compilation runs for each obfuscation
+            config. Optional, defaults to `runs`.
+        jobs: Number of parallel build jobs. The obfuscation and
+            compilation phases of different configs run concurrently on a
+            worker pool, each in its own working directory, while the
+            measured execution runs stay sequential.
+        build_cpus: List of CPU ids the build processes are pinned to.
+            Optional, defaults to no pinning.
+        run_cpus: List of CPU ids the measured program executions are
+            pinned to. Reserving a quiet set of CPUs for the measured
+            runs keeps the timing numbers stable while builds run on the
+            remaining CPUs. Optional, defaults to no pinning.
+        queue_depth: Maximum number of built-but-not-yet-measured configs
+            the build stage may run ahead of the measure stage (on top of
+            the `jobs` builds that can be in flight). Bounds the disk
+            space used by prepared binaries.
+        target_ci: Target relative confidence interval (95%) for the
+            execution wall time, e.g. 0.02 for plus/minus 2%. When given,
+            sampling is sequential: each unit stops as soon as the target
+            is met (after at least `min_runs` runs), and `runs` acts as
+            the maximum number of runs. Optional, defaults to fixed-count
+            sampling.
+        min_runs: Minimum number of execution runs per unit before the
+            confidence interval check may stop the sampling. Only used
+            when `target_ci` is given.
+        run_order: Execution order of the measured runs across the ready
+            units: "grouped" completes all runs of one unit before the
+            next, "roundrobin" interleaves one run per unit in rotation,
+            "shuffle" picks a random ready unit for each run.
+            Interleaving spreads each unit's samples across the campaign
+            timeline, so slow system drift (thermal throttling,
+            background load) becomes variance within units instead of
+            systematic bias between them.
+        workspace: Directory under which the temporary working directory
+            is created. Pointing it at a tmpfs mount (e.g. "/dev/shm")
+            keeps the generated sources and binaries memory-resident, so
+            the build phases do not pay for disk writeback and the
+            measured runs are not polluted by I/O noise. Optional,
+            defaults to the system temporary directory.
+        perf_events: List of hardware event names counted during the
+            measured runs with `perf stat` (see `DEFAULT_PERF_EVENTS`).
+            The counts, plus the derived IPC and miss rates, are
+            reported as additional execution metrics, allowing slowdowns
+            to be attributed (e.g. icache blowup versus branch
+            mispredictions) without a second measurement pass under
+            perf. Optional, defaults to no counters. Requires that
+            `perf` is installed.
+        sample_interval: Interval (in seconds) between resource usage
+            samples of the measured runs. When given, the RSS/CPU
+            timeline of every measured run is recorded in the result
+            container, so the shape of the memory curve (e.g. a brief
+            JIT spike versus a steadily bloated interpreter) can be
+            inspected, not just its peak. Optional, defaults to no
+            timeline sampling.
+        ncd_compressor: Compressor used for the normalized compression
+            distance metric, one of `metrics.NCD_COMPRESSORS`. The
+            default "bz2" needs no extra dependency; "zstd" and "lz4"
+            are much faster on large obfuscated outputs (e.g.
+            Virtualize) with practically identical rankings.
+        harness_iterations: Number of in-process workload iterations of
+            the injected timing harness. When given, the generated
+            source wraps the original `main` in a loop around
+            `clock_gettime` and the average per-iteration nanoseconds
+            are reported as the `execution_iteration_time` metric. This
+            resolves obfuscation overhead on microsecond-scale kernels,
+            where whole-process measurement is swamped by fork/exec,
+            dynamic linking and libc startup. Optional, defaults to no
+            harness.
+        isolate: Whether to run the measured executions in isolation
+            mode: address space layout randomization is disabled for
+            the measured program (so the memory layout is identical run
+            after run) and the performance cpufreq governor is asserted
+            on all CPUs (best effort: without the needed privileges a
+            warning is printed instead). Combine with `run_cpus` (to
+            shield the measured runs on a reserved cpuset) and an
+            interleaving `run_order` for the full effect; the isolation
+            settings are recorded in the result container metadata, so
+            campaigns measured under different settings are not
+            silently compared.
+        cooldown: Seconds slept after every measured run, giving the
+            CPU time to dissipate heat so thermally heavy configs do
+            not throttle the runs that follow them. Optional, defaults
+            to no cooldown.
+        measure_energy: Whether to read the RAPL energy counters around
+            every measured run, reporting joules per run and average
+            watts as the `execution_energy` and `execution_avg_power`
+            metrics. The counters are socket-wide, so the machine
+            should be otherwise idle for the numbers to be
+            attributable. Requires read access to the RAPL sysfs
+            counters (root on most machines), see
+            `rm.rapl_available()`.
+        program_args: Argument template passed to the measured program,
+            e.g. "sort {n}". The "{n}" placeholder is substituted with
+            the current input size when an input sweep is given.
+            Optional, defaults to no arguments.
+        input_sweep: List of input sizes to sweep. Each (program,
+            config) unit is built once and then measured separately for
+            every size, with the results keyed "<unit>@<size>", so how
+            the obfuscation overhead scales with the data size becomes
+            visible (e.g. Virtualize's interpreter penalty grows with
+            the iteration count, encode_literals is flat). Requires
+            `program_args` with a "{n}" placeholder. Optional, defaults
+            to a single measurement per unit.
+        results_store: Durable store each completed unit is appended to
+            as soon as its measured runs finish, so a crash or
+            interrupt mid-campaign loses at most the units still in
+            progress. Optional, defaults to no checkpointing.
+        resume: Whether to skip the units already present in
+            `results_store` (completed by a previous, interrupted
+            campaign); their stored samples are merged into the
+            returned results instead of being measured again. Requires
+            `results_store`.
+        keep_samples: Whether the returned container retains the raw
+            samples, on top of the streaming summary accumulators (see
+            `rc.ResultContainer`). The raw samples are only needed for
+            the distribution plots and the raw JSON dump; disabling
+            retention keeps the container memory constant per metric
+            at matrix scale.
+        baseline: Path of a previous campaign's results file (the JSON
+            output or the results store) whose baseline ("00-normal")
+            samples are merged into the results instead of
+            re-measuring the identity config. The recorded environment
+            fingerprint must match the current one (see
+            `environment_fingerprint`), so a changed CPU, compiler or
+            obfuscator is not papered over. Optional, defaults to
+            measuring the baseline like every other config.
+        time_budget: Total campaign time budget in seconds. When the
+            duration-weighted projection (see `status_callback`) says
+            the campaign will not finish within the budget, measured
+            runs are trimmed from the most expensive unfinished units
+            first (a dropped run of the slowest config buys the most
+            time back per lost sample), but never below
+            min(`min_runs`, `runs`) runs per unit, so every unit still
+            gets a usable sample count. Optional, defaults to no
+            budget.
+        status_callback: Callback called with a short status string
+            (currently the duration-weighted ETA, e.g. "ETA 1:02:03")
+            whenever the projection is refreshed. Unlike the step
+            counting behind `step_callback`, the projection weights
+            each remaining build and run by its observed per-unit mean
+            duration (seeded from the results store or the baseline
+            file when available), so slow configs do not masquerade as
+            a handful of quick steps. Optional, defaults to no status
+            reporting.
+        adaptive_warmup: Whether the warmup of each unit stops as soon
+            as its timing sequence reaches steady state (the relative
+            spread of the last few warmup wall times drops below a
+            small tolerance, see `__is_steady_state`), with `warmup`
+            acting as the maximum. A fixed count wastes runs on units
+            that settle immediately and under-warms units whose
+            first-touch effects (cold page cache, frequency ramp-up)
+            last longer; the number of warmup runs actually performed
+            is reported as the `execution_warmup_runs` metric, so an
+            exhausted maximum is visible in the results. Requires
+            `warmup` >= 1. Optional, defaults to the fixed count.
 
     Returns:
         ResultContainer containing the results of the analysis.
@@ -110,165 +739,1256 @@ def perform_analysis(source_code_path: str,
         CalledProcessError: If a command fails.
     """
 
+    # per-phase run counts default to the execution run count
+    if obf_runs is None:
+        obf_runs = runs
+    if compile_runs is None:
+        compile_runs = runs
+
     # validate arguments
     if runs < 1:
         raise ValueError("`runs` must be >= 1")
     if warmup < 0:
         raise ValueError("`warmup` must be >= 0")
+    if obf_runs < 1:
+        raise ValueError("`obf_runs` must be >= 1")
+    if compile_runs < 1:
+        raise ValueError("`compile_runs` must be >= 1")
     if optimization_level < 0 or optimization_level > 3:
         raise ValueError("`optimization_level` must be between 0 and 3")
     if len(obf_configs) < 1:
         raise ValueError("`obf_configs` must contain at least one config")
-
-    # get the absolute path of the source code file
-    source_code_full_path = os.path.abspath(source_code_path)
-    # get the source code filename without the path
-    source_code_filename = os.path.basename(source_code_path)
-    # get the sourcd code filename without the extension
-    source_code_filename_no_ext = os.path.splitext(source_code_filename)[0]
+    if jobs < 1:
+        raise ValueError("`jobs` must be >= 1")
+    if queue_depth < 1:
+        raise ValueError("`queue_depth` must be >= 1")
+    if target_ci is not None:
+        if target_ci <= 0:
+            raise ValueError("`target_ci` must be > 0")
+        if min_runs < 2:
+            # at least two samples are needed to estimate the variance
+            raise ValueError("`min_runs` must be >= 2")
+        if min_runs > runs:
+            raise ValueError("`min_runs` must be <= `runs`")
+    if run_order not in ("grouped", "roundrobin", "shuffle"):
+        raise ValueError("`run_order` must be 'grouped', 'roundrobin'"
+                         " or 'shuffle'")
+    if workspace is not None and not os.path.isdir(workspace):
+        raise ValueError(f"`workspace` must be an existing directory:"
+                         f" '{workspace}'")
+    if ncd_compressor not in metrics.NCD_COMPRESSORS:
+        raise ValueError(f"`ncd_compressor` must be one of"
+                         f" {metrics.NCD_COMPRESSORS}")
+    if harness_iterations is not None and harness_iterations < 1:
+        raise ValueError("`harness_iterations` must be >= 1")
+    if cooldown < 0:
+        raise ValueError("`cooldown` must be >= 0")
+    if input_sweep is not None:
+        if len(input_sweep) < 1:
+            raise ValueError("`input_sweep` must contain at least one size")
+        if program_args is None or "{n}" not in program_args:
+            raise ValueError("`input_sweep` requires `program_args`"
+                             " with a '{n}' placeholder")
+    if resume and results_store is None:
+        raise ValueError("`resume` requires `results_store`")
+    if time_budget is not None and time_budget <= 0:
+        raise ValueError("`time_budget` must be > 0")
+    if adaptive_warmup and warmup < 1:
+        raise ValueError("`adaptive_warmup` requires `warmup` >= 1")
+
+    # normalize the source code path(s) to a list of absolute paths
+    if isinstance(source_code_path, str):
+        source_code_path_list = [ source_code_path ]
+    else:
+        source_code_path_list = list(source_code_path)
+    if len(source_code_path_list) < 1:
+        raise ValueError("`source_code_path` must contain at least one file")
+    source_code_full_paths = [ os.path.abspath(path)
+                               for path in source_code_path_list ]
+
+    # load the previous campaign's baseline samples, when given,
+    # refusing samples measured in a different environment
+    baseline_samples = None
+    if baseline is not None:
+        baseline_samples, baseline_environment = \
+            load_baseline_samples(baseline)
+        __check_recorded_environment(baseline_environment, baseline)
 
     # create the result container
-    results = rc.ResultContainer()
-
-    # save the current working directory
-    old_cwd = os.getcwd()
+    results = rc.ResultContainer(keep_samples=keep_samples)
+
+    # record the measurement environment with the results, so future
+    # campaigns can verify comparability before reusing them
+    results.set_metadata({ "environment": environment_fingerprint() })
+
+    # in isolation mode, assert the performance governor and record the
+    # isolation settings in the result container metadata, so results
+    # measured under different settings are not silently compared
+    if isolate:
+        governor = __assert_performance_governor()
+        results.set_metadata({
+            "isolation": {
+                "aslr_disabled": True,
+                "cpu_governor": governor,
+                "run_cpus": run_cpus if run_cpus else "unpinned",
+                "cooldown": cooldown
+            }
+        })
 
     # create a temporary directory in which to run the analysis
     # to avoid polluting the current working directory
-    with tempfile.TemporaryDirectory() as tmp_dir_name:
-        # change the current working directory to the temp directory
-        os.chdir(tmp_dir_name)
-
-        # repeat the analysis for each obfuscation config
-        for obf_config in obf_configs:
-            # get the obfuscation config filename without the path
-            obf_config_filename = os.path.basename(obf_config[0])
-            # get the obfuscation config filename without the extension
-            obf_config_filename_no_ext = \
-                os.path.splitext(obf_config_filename)[0]
-
-            # dynamically generate new source code file with the required
-            # tigress headers, depending on the obfuscation config
-            # (same filename, but stored in the temp directory)
-            new_source_code_path = source_code_filename
-            __create_tigress_source_code(source_code_full_path,
-                                         new_source_code_path,
-                                         obf_config)
-
-            # output obfuscated source code filename
-            obf_file = f"{source_code_filename_no_ext}" \
-                       f"-{obf_config_filename_no_ext}.c"
-
-            # obfuscate the source code to compute the static metrics
-            # that do not change run after run
-            __obfuscate(new_source_code_path, obf_file, obf_config)
-
-            # compute static metrics that do not change run after run
-            # in reality they might change, but we assume that the
-            # variability is negligible and since they are expensive
-            # to compute, we compute them only once
-            ncd = metrics.normalized_compression_distance(source_code_full_path,
-                                                          obf_file)
-            halstead_difficulty = \
-                metrics.halstead_difficulty(source_code_full_path, obf_file)
-
-            # perform the warmup runs
-            for _ in range(warmup):
-                # run the analysis, but do not save the results
-                __obfuscate_compile_run(new_source_code_path,
-                                        obf_file,
-                                        obf_config,
-                                        optimization_level)
-                # call the callback function
+    # (placed under `workspace` when given, e.g. on a tmpfs mount)
+    with tempfile.TemporaryDirectory(dir=workspace) as tmp_dir_name:
+        # the results store carries the environment fingerprint of the
+        # machine its samples were measured on: verify it before
+        # resuming, and record it when the store has none yet
+        if results_store is not None:
+            if resume:
+                __check_recorded_environment(results_store.environment(),
+                                             results_store.path())
+            if results_store.environment() is None:
+                results_store.record_environment(environment_fingerprint())
+
+        # units completed by a previous (interrupted) campaign, skipped
+        # when resuming; their stored samples are merged at the end
+        completed_units = set(results_store.completed_units()) \
+                          if results_store is not None and resume else set()
+        # baseline units loaded from a previous campaign are not
+        # re-measured either
+        if baseline_samples is not None:
+            completed_units |= set(baseline_samples.keys())
+
+        # measurement variants of each unit: one (name suffix, argv)
+        # per sweep size, or a single unsuffixed one
+        template_args = shlex.split(program_args) if program_args else []
+        if input_sweep is not None:
+            run_variants = [ (f"@{size}",
+                              [ arg.replace("{n}", str(size))
+                                for arg in template_args ])
+                             for size in input_sweep ]
+        else:
+            run_variants = [ ("", template_args) ]
+
+        # number of progress steps a completed build accounts for
+        build_steps = obf_runs \
+                      + (compile_runs if optimization_level > 0 else 0)
+
+        # prepare one build job per (program, config) unit of the matrix,
+        # each with its own working directory, so builds can run
+        # concurrently without stepping on each other (and without
+        # mutating the process cwd)
+        build_jobs = []
+        # ordered list of unit names, for the deterministic final output
+        unit_names = []
+        for source_code_full_path in source_code_full_paths:
+            # get the source code filename without the path
+            source_code_filename = os.path.basename(source_code_full_path)
+            # get the source code filename without the extension
+            source_code_filename_no_ext = \
+                os.path.splitext(source_code_filename)[0]
+
+            for obf_config in obf_configs:
+                # get the obfuscation config filename without the path
+                obf_config_filename = os.path.basename(obf_config[0])
+                # get the obfuscation config filename without the extension
+                obf_config_filename_no_ext = \
+                    os.path.splitext(obf_config_filename)[0]
+
+                # results are keyed by config name for a single program,
+                # by "<program>:<config>" for a matrix
+                if len(source_code_full_paths) == 1:
+                    unit_name = obf_config_filename_no_ext
+                else:
+                    unit_name = f"{source_code_filename_no_ext}" \
+                                f":{obf_config_filename_no_ext}"
+                # with an input sweep, each unit is measured once per
+                # size, keyed "<unit>@<size>"
+                if input_sweep is not None:
+                    for size in input_sweep:
+                        unit_names.append(f"{unit_name}@{size}")
+                else:
+                    unit_names.append(unit_name)
+
+                # when every measurement variant of this unit is
+                # already in the results store, skip its build and runs
+                # entirely, only advancing the progress bar
+                if completed_units.issuperset(
+                        unit_name + suffix for suffix, _ in run_variants):
+                    if step_callback:
+                        for _ in range(build_steps
+                                       + (warmup + runs)
+                                         * len(run_variants)):
+                            step_callback()
+                    continue
+
+                # per-unit working directory
+                unit_dir = os.path.join(tmp_dir_name,
+                                        source_code_filename_no_ext,
+                                        obf_config_filename_no_ext)
+                os.makedirs(unit_dir, exist_ok=True)
+
+                build_jobs.append((source_code_full_path,
+                                   source_code_filename,
+                                   obf_config_filename_no_ext,
+                                   unit_name,
+                                   unit_dir,
+                                   obf_config,
+                                   optimization_level,
+                                   obf_runs,
+                                   compile_runs,
+                                   obf_cache,
+                                   compile_cache,
+                                   build_cpus,
+                                   ncd_compressor,
+                                   harness_iterations))
+
+        # --- pipelined build/measure scheduler ---
+        # the build stage produces binaries into the per-config
+        # directories on a worker pool, while the measure stage consumes
+        # them in the main process; this way the next configs'
+        # tigress/gcc work overlaps the current config's measured runs
+        # (which are sequential, and optionally pinned to a reserved set
+        # of CPUs, so parallelism does not pollute the timing numbers).
+        # the bounded window keeps at most `jobs + queue_depth` builds
+        # in flight or awaiting measurement, so the pipeline does not
+        # build arbitrarily far ahead of the measure stage
+
+        # samples measured for each config
+        # (filled in completion order, inserted into the result
+        # container in config order to keep the output deterministic)
+        measured_samples: Dict[str, Dict[str, List[Union[int, float]]]] = {}
+        # resource usage timelines measured for each config
+        # (one per measured run, only with timeline sampling enabled)
+        measured_timelines: Dict[str,
+                                 List[List[Tuple[float, int, float]]]] = {}
+
+        # output-hash deduplication: the first unit producing a given
+        # obfuscated output for a given program becomes its canonical
+        # unit; later units with the same output skip their measured
+        # runs and share the canonical execution samples
+        # dict<(source_path,output_hash),unit_name>
+        output_hash_units: Dict[Tuple[str, str], str] = {}
+        # dict<duplicate_unit_name,canonical_unit_name>
+        duplicate_of: Dict[str, str] = {}
+        # build samples of the duplicate units (their obfuscation
+        # metrics are still their own, only the execution is shared)
+        duplicate_build_samples: Dict[str,
+                                      Dict[str,
+                                           List[Union[int, float]]]] = {}
+
+        # measured runs discard the program output (see `__run`), except
+        # in harness mode, where the per-iteration times are reported on
+        # stderr and must be captured
+        run_capture_policy = "capture" if harness_iterations is not None \
+                             else "discard"
+
+        # duration-weighted remaining time estimation: the per-unit
+        # build and run durations are recorded as the campaign
+        # proceeds, seeded from the stored samples of previous
+        # campaigns when available, so the ETA reflects how expensive
+        # each remaining unit actually is instead of counting equal
+        # abstract steps
+        eta = _EtaEstimator()
+        if results_store is not None:
+            for stored_unit in results_store.completed_units():
+                eta.seed_from_samples(stored_unit,
+                                      results_store.unit_samples(stored_unit),
+                                      obf_runs,
+                                      compile_runs)
+        if baseline_samples is not None:
+            for baseline_unit, baseline_unit_samples \
+                    in baseline_samples.items():
+                eta.seed_from_samples(baseline_unit,
+                                      baseline_unit_samples,
+                                      obf_runs,
+                                      compile_runs)
+        campaign_start = time.monotonic()
+
+        # per-variant measured run allowance, trimmed below `runs` when
+        # the time budget would otherwise be exceeded (but never below
+        # the floor); variants keep the full allowance until trimmed
+        run_budget: Dict[str, int] = {}
+        run_floor = min(min_runs, runs)
+        budget_warned = False
+
+        # queue of build jobs not submitted yet
+        pending = deque(build_jobs)
+
+        with ProcessPoolExecutor(max_workers=jobs) as pool:
+            # builds currently in flight
+            in_flight: Dict = {}
+            # submission time of each in-flight build, for the
+            # duration records
+            build_started: Dict = {}
+            # units whose binary is ready, currently being measured;
+            # each entry is the mutable measurement state of one unit
+            active: deque = deque()
+
+            def remaining_seconds() -> Optional[float]:
+                """Predicts the remaining campaign time, in seconds.
+
+                Sums the predicted durations of everything still to do:
+                the builds and all the runs of the queued and in-flight
+                units, and the remaining runs of the units being
+                measured (each measured run also pays the cooldown).
+
+                Returns:
+                    The predicted remaining seconds, or None while no
+                    duration of some needed phase has been observed or
+                    seeded yet.
+                """
+
+                total = 0.0
+
+                # units still to build: their build plus all their runs
+                for job in itertools.chain(pending, in_flight.values()):
+                    job_unit_name = job[3]
+                    build_estimate = eta.predict_build(job_unit_name)
+                    if build_estimate is None:
+                        return None
+                    total += build_estimate
+                    for suffix, _ in run_variants:
+                        variant_name = job_unit_name + suffix
+                        if variant_name in completed_units:
+                            continue
+                        run_estimate = eta.predict_run(variant_name)
+                        if run_estimate is None:
+                            return None
+                        total += warmup * run_estimate \
+                                 + run_budget.get(variant_name, runs) \
+                                   * (run_estimate + cooldown)
+
+                # units already built: their remaining runs
+                for unit in active:
+                    run_estimate = eta.predict_run(unit["name"])
+                    if run_estimate is None:
+                        return None
+                    remaining_runs = run_budget.get(unit["name"], runs) \
+                                     - len(unit["wall_times"])
+                    total += max(remaining_runs, 0) \
+                             * (run_estimate + cooldown)
+                    if not unit["warmup_done"]:
+                        total += warmup * run_estimate
+
+                return total
+
+            def enforce_time_budget(remaining: float) -> float:
+                """Trims measured runs until the projection fits the
+                time budget.
+
+                Runs are dropped one at a time from the unfinished unit
+                with the most expensive runs (the dropped run of the
+                slowest config buys the most time back per sacrificed
+                sample), never below the floor, until the projected
+                finish fits the budget or nothing is left to trim.
+
+                Args:
+                    remaining: The current remaining time projection.
+
+                Returns:
+                    The remaining time projection after the trimming.
+                """
+
+                nonlocal budget_warned
+
+                assert time_budget is not None
+                elapsed = time.monotonic() - campaign_start
+
+                while elapsed + remaining > time_budget:
+                    # find the trimmable variant with the costliest runs
+                    best_name: Optional[str] = None
+                    best_cost = 0.0
+                    for job in itertools.chain(pending,
+                                               in_flight.values()):
+                        for suffix, _ in run_variants:
+                            variant_name = job[3] + suffix
+                            if variant_name in completed_units:
+                                continue
+                            if run_budget.get(variant_name, runs) \
+                                    <= run_floor:
+                                continue
+                            run_estimate = eta.predict_run(variant_name)
+                            if run_estimate is not None \
+                               and run_estimate > best_cost:
+                                best_name = variant_name
+                                best_cost = run_estimate
+                    for unit in active:
+                        # runs already taken cannot be trimmed away
+                        floor = max(run_floor, len(unit["wall_times"]))
+                        if run_budget.get(unit["name"], runs) <= floor:
+                            continue
+                        run_estimate = eta.predict_run(unit["name"])
+                        if run_estimate is not None \
+                           and run_estimate > best_cost:
+                            best_name = unit["name"]
+                            best_cost = run_estimate
+
+                    if best_name is None:
+                        # every unfinished unit is at the floor: the
+                        # budget cannot be met, keep the floor runs
+                        break
+
+                    if not budget_warned:
+                        print(f"Warning: the campaign is projected to"
+                              f" exceed the time budget, trimming"
+                              f" measured runs (down to {run_floor}"
+                              f" per unit) starting from the most"
+                              f" expensive configs",
+                              file=sys.stderr)
+                        budget_warned = True
+
+                    run_budget[best_name] = \
+                        run_budget.get(best_name, runs) - 1
+                    remaining -= best_cost + cooldown
+
+                return remaining
+
+            while pending or in_flight or active:
+                # fill the submission window; built-but-not-yet-measured
+                # units count against it too, so the build stage cannot
+                # run more than `queue_depth` configs ahead of the
+                # measure stage
+                while pending \
+                        and len(in_flight) + len(active) \
+                            < jobs + queue_depth:
+                    job = pending.popleft()
+                    future = pool.submit(__build_config, *job)
+                    in_flight[future] = job
+                    build_started[future] = time.monotonic()
+
+                # collect completed builds; block only when there is no
+                # measurement work to interleave in the meanwhile
+                if in_flight:
+                    done, _ = wait(in_flight.keys(),
+                                   timeout=0 if active else None,
+                                   return_when=FIRST_COMPLETED)
+                    for future in done:
+                        job = in_flight.pop(future)
+                        unit_name, unit_dir, samples, obf_hash = \
+                            future.result()
+                        # the elapsed time since submission includes
+                        # possible pool queueing, which predicts the
+                        # remaining builds as they will actually flow
+                        # through the same pool
+                        eta.record_build(unit_name,
+                                         time.monotonic()
+                                         - build_started.pop(future))
+
+                        # advance the progress bar by one whole build
+                        if step_callback:
+                            for _ in range(build_steps): step_callback()
+
+                        # configs whose obfuscated output is identical
+                        # for this program (e.g. a swept option that is
+                        # a no-op for the source) share the canonical
+                        # unit's execution measurements instead of
+                        # paying for their own measured runs
+                        dedup_key = (job[0], obf_hash)
+                        canonical_name = output_hash_units.get(dedup_key)
+                        if canonical_name is not None:
+                            for suffix, _ in run_variants:
+                                variant_name = unit_name + suffix
+                                if variant_name in completed_units:
+                                    continue
+                                duplicate_of[variant_name] = \
+                                    canonical_name + suffix
+                                duplicate_build_samples[variant_name] = \
+                                    { metric: list(values)
+                                      for metric, values
+                                      in samples.items() }
+                                # the skipped runs still advance the
+                                # progress bar
+                                if step_callback:
+                                    for _ in range(warmup + runs):
+                                        step_callback()
+                            continue
+                        output_hash_units[dedup_key] = unit_name
+
+                        # pre-fault the built executable into the page
+                        # cache, so the first measured runs do not pay
+                        # for the disk reads (visible as major page
+                        # fault outliers)
+                        __prefault_file(os.path.join(unit_dir, "a.out"))
+
+                        # the unit joins the measurement rotation, one
+                        # variant per sweep size; the variants share the
+                        # binary built once, but each gets its own copy
+                        # of the build samples, so every results column
+                        # is complete
+                        for suffix, run_args in run_variants:
+                            variant_name = unit_name + suffix
+                            if variant_name in completed_units:
+                                # this sweep variant was measured by a
+                                # previous campaign: only advance the
+                                # progress bar
+                                if step_callback:
+                                    for _ in range(warmup + runs):
+                                        step_callback()
+                                continue
+                            active.append({
+                                "name": variant_name,
+                                "dir": unit_dir,
+                                "samples": defaultdict(
+                                    list,
+                                    { metric: list(values)
+                                      for metric, values
+                                      in samples.items() }),
+                                "run_args": run_args,
+                                "wall_times": [],
+                                "timelines": [],
+                                "warmup_done": False })
+
+                if not active:
+                    continue
+
+                # pick the next unit to measure according to the
+                # requested execution order:
+                # - "grouped": complete all runs of one unit before
+                #   touching the next (legacy behavior)
+                # - "roundrobin": one run per ready unit, in rotation
+                # - "shuffle": one run of a randomly chosen ready unit
+                # interleaving spreads each unit's samples across the
+                # campaign timeline, so slow system drift (thermal
+                # throttling, background load) shows up as variance
+                # within each unit instead of bias between units
+                if run_order == "roundrobin":
+                    active.rotate(-1)
+                    unit = active[-1]
+                elif run_order == "shuffle":
+                    unit = active[random.randrange(len(active))]
+                else:
+                    unit = active[0]
+
+                # perform the warmup runs the first time a unit is
+                # selected, so they land right before its first sample
+                if not unit["warmup_done"]:
+                    warmup_times: List[float] = []
+                    while len(warmup_times) < warmup:
+                        # run the program, but do not save the results
+                        run_start = time.monotonic()
+                        monitor = __run("a.out",
+                                        cwd=unit["dir"],
+                                        cpu_affinity=run_cpus,
+                                        disable_aslr=isolate,
+                                        run_args=unit["run_args"])
+                        eta.record_run(unit["name"],
+                                       time.monotonic() - run_start)
+                        warmup_times.append(monitor.wall_time())
+                        if step_callback: step_callback()
+                        # in adaptive mode, stop warming up as soon as
+                        # the timing sequence settles (`warmup` is the
+                        # maximum); the first-touch effects show up as
+                        # a descending head of the sequence
+                        if adaptive_warmup \
+                           and __is_steady_state(warmup_times):
+                            break
+                    if adaptive_warmup:
+                        # report how many warmup runs were needed, so
+                        # an exhausted maximum (i.e. a unit that never
+                        # settled) is visible in the results
+                        unit["samples"]["execution_warmup_runs"] \
+                            .append(len(warmup_times))
+                        # the warmup runs forgone by an early steady
+                        # state still advance the progress bar
+                        if step_callback:
+                            for _ in range(warmup - len(warmup_times)):
+                                step_callback()
+                    unit["warmup_done"] = True
+
+                # one measured run of the selected unit
+                run_start = time.monotonic()
+                wall_time = __measure_run(unit["dir"],
+                                          unit["samples"],
+                                          run_cpus,
+                                          perf_events,
+                                          sample_interval,
+                                          unit["timelines"],
+                                          disable_aslr=isolate,
+                                          capture_policy=run_capture_policy,
+                                          measure_energy=measure_energy,
+                                          run_args=unit["run_args"])
+                unit["wall_times"].append(wall_time)
+                # the elapsed time, not the program's wall time: the
+                # remaining runs also pay for the measurement overhead
+                # (perf, timeline sampling, energy counters)
+                eta.record_run(unit["name"],
+                               time.monotonic() - run_start)
                 if step_callback: step_callback()
 
-            # perform the actual runs
-            for _ in range(runs):
-                # run the analysis
-                obf_monitor, gcc1_monitor, gcc2_monitor, prg_monitor = \
-                    __obfuscate_compile_run(new_source_code_path,
-                                            obf_file,
-                                            obf_config,
-                                            optimization_level)
-
-                # compute tigress obfuscation process related metrics;
-                # need to subtract the gcc1 times, because they are
-                # included in the obfuscation times, since the tigress
-                # obfuscation process concludes with a call to gcc;
-                # to avoid negative values, we take the max with 0
-                obf_wall_time = max(0, obf_monitor.wall_time()
-                                       - gcc1_monitor.wall_time())
-                obf_user_time = max(0, obf_monitor.user_time()
-                                       - gcc1_monitor.user_time())
-                obf_system_time = max(0, obf_monitor.system_time()
-                                         - gcc1_monitor.system_time())
-
-                # compute some metrics
-                # (bytes to kilobytes)
-                obf_code_size = metrics.file_size(obf_file) / 1000
-                bin_size = metrics.file_size("a.out") / 1000
-                line_count = metrics.line_count(obf_file)
-
-                # build the result by extracting the relevant data
-                result = rc.Result(
-                    name=obf_config_filename_no_ext,
-                    obfuscation_wall_time=obf_wall_time,
-                    obfuscation_user_time=obf_user_time,
-                    obfuscation_system_time=obf_system_time,
-                    obfuscation_memory=obf_monitor.max_memory(),
-                    compile_wall_time=gcc2_monitor.wall_time(),
-                    compile_user_time=gcc2_monitor.user_time(),
-                    compile_system_time=gcc2_monitor.system_time(),
-                    source_code_size=obf_code_size,
-                    executable_size=bin_size,
-                    lines_of_code=line_count,
-                    norm_compression_distance=ncd,
-                    halstead_difficulty=halstead_difficulty,
-                    execution_wall_time=prg_monitor.wall_time(),
-                    execution_user_time=prg_monitor.user_time(),
-                    execution_system_time=prg_monitor.system_time(),
-                    execution_memory=prg_monitor.max_memory(),
-                    execution_minor_page_faults=
-                        prg_monitor.major_page_faults(),
-                    execution_major_page_faults=
-                        prg_monitor.minor_page_faults(),
-                    execution_total_page_faults=prg_monitor.page_faults(),
-                    execution_voluntary_context_switches=
-                        prg_monitor.volountary_context_switches(),
-                    execution_involuntary_context_switches=
-                        prg_monitor.involountary_context_switches(),
-                    execution_total_context_switches=
-                        prg_monitor.context_switches()
-                )
-                # add the result to the ResultContainer
-                results.add_result(result)
-
-                # call the callback function
-                if step_callback: step_callback() # type: ignore
-
-        # chdir to initial cwd
-        os.chdir(old_cwd)
+                # let the CPU dissipate heat before the next run, so
+                # thermally heavy configs do not throttle the runs that
+                # follow them (with an interleaving run order the
+                # cooldowns spread across all units evenly)
+                if cooldown > 0:
+                    time.sleep(cooldown)
+
+                # refresh the duration-weighted projection, enforce the
+                # time budget against it and report the ETA
+                if time_budget is not None or status_callback:
+                    remaining = remaining_seconds()
+                    if time_budget is not None and remaining is not None:
+                        remaining = enforce_time_budget(remaining)
+                    if status_callback:
+                        if remaining is not None:
+                            status_callback(
+                                f"ETA {__format_duration(remaining)}")
+                        else:
+                            status_callback("ETA -:--:--")
+
+                # check whether the unit is done: either the run
+                # allowance (possibly trimmed by the time budget) is
+                # exhausted, or (in adaptive mode) the confidence
+                # interval target is met
+                done_measuring = len(unit["wall_times"]) \
+                                 >= run_budget.get(unit["name"], runs)
+                if not done_measuring and target_ci is not None:
+                    done_measuring = \
+                        len(unit["wall_times"]) >= min_runs \
+                        and __relative_ci(unit["wall_times"]) <= target_ci
+                if done_measuring:
+                    active.remove(unit)
+                    # the runs forgone by an adaptive early stop or a
+                    # trimmed allowance still advance the progress bar,
+                    # like the runs skipped by resume and dedup do
+                    if step_callback:
+                        for _ in range(runs - len(unit["wall_times"])):
+                            step_callback()
+                    measured_samples[unit["name"]] = unit["samples"]
+                    measured_timelines[unit["name"]] = unit["timelines"]
+                    # checkpoint the completed unit, so an interrupted
+                    # campaign can be resumed from here
+                    if results_store is not None:
+                        results_store.record_unit(unit["name"],
+                                                  unit["samples"],
+                                                  unit["timelines"])
+
+        # resolve the duplicate units: their own build metrics, plus
+        # the canonical unit's execution metrics (and timelines)
+        for unit_name in unit_names:
+            if unit_name not in duplicate_of:
+                continue
+            canonical_name = duplicate_of[unit_name]
+            merged = dict(duplicate_build_samples[unit_name])
+            canonical_samples = measured_samples.get(canonical_name)
+            if canonical_samples is None:
+                # the canonical unit was itself skipped: its samples
+                # come from the baseline or the resumed store
+                if baseline_samples is not None \
+                   and canonical_name in baseline_samples:
+                    canonical_samples = baseline_samples[canonical_name]
+                else:
+                    assert results_store is not None
+                    canonical_samples = \
+                        results_store.unit_samples(canonical_name)
+            for metric_name, values in canonical_samples.items():
+                if metric_name.startswith("execution_"):
+                    merged[metric_name] = values
+            measured_samples[unit_name] = merged
+            measured_timelines[unit_name] = \
+                measured_timelines.get(canonical_name, [])
+            # checkpoint the deduplicated unit too, so a resumed
+            # campaign does not redo the dedup work
+            if results_store is not None:
+                results_store.record_unit(unit_name,
+                                          merged,
+                                          measured_timelines[unit_name])
+
+        # add all the collected samples to the ResultContainer,
+        # in (program, config) order
+        for unit_name in unit_names:
+            if unit_name not in measured_samples:
+                # not measured in this campaign: merge the baseline or
+                # the resumed store samples instead
+                if baseline_samples is not None \
+                   and unit_name in baseline_samples:
+                    for metric_name, values \
+                            in baseline_samples[unit_name].items():
+                        results.add_metric_samples(unit_name,
+                                                   metric_name,
+                                                   values)
+                else:
+                    # `resume` guarantees the store exists
+                    assert results_store is not None
+                    results_store.load_unit(results, unit_name)
+                continue
+            for metric_name, values in measured_samples[unit_name].items():
+                results.add_metric_samples(unit_name,
+                                           metric_name,
+                                           values)
+            for timeline in measured_timelines[unit_name]:
+                results.add_timeline(unit_name, timeline)
 
     return results
 
 
+def __assert_performance_governor() -> str:
+    """Tries to set the performance cpufreq governor on all CPUs.
+
+    The governor is set best effort: without the needed privileges (or
+    on machines without cpufreq, e.g. VMs) a warning is printed on
+    stderr instead of failing the analysis, since the measurements are
+    still valid, just noisier.
+
+    Returns:
+        The comma-separated set of governors in effect after the
+        attempt (normally just "performance"), or "unavailable" when
+        the machine exposes no cpufreq interface.
+    """
+
+    governor_paths = sorted(glob.glob(
+        "/sys/devices/system/cpu/cpu[0-9]*/cpufreq/scaling_governor"))
+    if not governor_paths:
+        # no cpufreq interface (e.g. a VM): nothing to assert
+        print("Warning: no cpufreq interface found,"
+              " cannot assert the performance governor",
+              file=sys.stderr)
+        return "unavailable"
+
+    governors = set()
+    for governor_path in governor_paths:
+        with open(governor_path) as f:
+            governor = f.read().strip()
+
+        if governor != "performance":
+            # try to switch the CPU to the performance governor
+            try:
+                with open(governor_path, 'w') as f:
+                    f.write("performance\n")
+                governor = "performance"
+            except OSError:
+                # not privileged: keep the current governor
+                pass
+
+        governors.add(governor)
+
+    if governors != { "performance" }:
+        print(f"Warning: could not assert the performance governor"
+              f" (in effect: {','.join(sorted(governors))});"
+              f" run as root or set it manually for stabler timings",
+              file=sys.stderr)
+
+    return ",".join(sorted(governors))
+
+
+def __prefault_file(path: str) -> None:
+    """Reads the file at the given path to fault it into the page cache.
+
+    Args:
+        path: Path of the file to pre-fault.
+
+    Raises:
+        OSError: If the file cannot be read.
+    """
+
+    with open(path, 'rb') as f:
+        # reading the whole file pulls all its pages into memory
+        while f.read(1024 * 1024):
+            pass
+
+
+def __measure_run(config_dir: str,
+                  samples: Dict[str, List[Union[int, float]]],
+                  run_cpus: Optional[List[int]],
+                  perf_events: Optional[List[str]] = None,
+                  sample_interval: Optional[float] = None,
+                  timelines: Optional[List[List[Tuple[float,
+                                                      int,
+                                                      float]]]] = None,
+                  disable_aslr: bool = False,
+                  capture_policy: str = "discard",
+                  measure_energy: bool = False,
+                  run_args: Optional[List[str]] = None
+                  ) -> float:
+    """Performs a single measured execution run of an already-built config.
+
+    Runs the binary left in `config_dir` by the build stage once,
+    appending the execution metric samples to `samples`.
+
+    Args:
+        config_dir: Working directory of the config, containing the
+            compiled `a.out`.
+        samples: Samples collected so far for the config; the execution
+            samples are appended to it.
+        run_cpus: List of CPU ids the measured execution is pinned to.
+            Optional.
+        perf_events: List of hardware event names counted during the
+            run. Optional.
+        sample_interval: Interval (in seconds) between resource usage
+            timeline samples. Optional.
+        timelines: List the run's timeline is appended to. Required
+            when `sample_interval` is given.
+        disable_aslr: Whether to disable address space layout
+            randomization for the run (isolation mode).
+        capture_policy: What to do with the program output, one of
+            `rm.CAPTURE_POLICIES`. Defaults to "discard", so programs
+            with heavy verification output are not benchmarked writing
+            into capture files.
+        measure_energy: Whether to read the RAPL energy counters around
+            the run.
+        run_args: Arguments passed to the measured program. Optional.
+
+    Returns:
+        The execution wall time of the run.
+
+    Raises:
+        CalledProcessError: If the program fails.
+    """
+
+    prg_monitor = __run("a.out",
+                        cwd=config_dir,
+                        cpu_affinity=run_cpus,
+                        perf_events=perf_events,
+                        sample_interval=sample_interval,
+                        disable_aslr=disable_aslr,
+                        capture_policy=capture_policy,
+                        measure_energy=measure_energy,
+                        run_args=run_args)
+
+    # record the resource usage timeline of the run
+    if sample_interval is not None and timelines is not None:
+        timelines.append(prg_monitor.timeline())
+
+    samples["execution_wall_time"].append(prg_monitor.wall_time())
+    samples["execution_user_time"].append(prg_monitor.user_time())
+    samples["execution_system_time"].append(prg_monitor.system_time())
+    samples["execution_memory"].append(prg_monitor.max_memory())
+    samples["execution_minor_page_faults"].append(
+        prg_monitor.minor_page_faults())
+    samples["execution_major_page_faults"].append(
+        prg_monitor.major_page_faults())
+    samples["execution_total_page_faults"].append(
+        prg_monitor.page_faults())
+    samples["execution_voluntary_context_switches"].append(
+        prg_monitor.volountary_context_switches())
+    samples["execution_involuntary_context_switches"].append(
+        prg_monitor.involountary_context_switches())
+    samples["execution_total_context_switches"].append(
+        prg_monitor.context_switches())
+
+    # hardware performance counters, plus the derived IPC and miss
+    # rates, when perf measurement is enabled
+    counters = prg_monitor.perf_counters()
+    if counters:
+        cycles = counters.get("cycles")
+        instructions = counters.get("instructions")
+        cache_references = counters.get("cache-references")
+        cache_misses = counters.get("cache-misses")
+        branch_instructions = counters.get("branch-instructions")
+        branch_misses = counters.get("branch-misses")
+
+        if cycles is not None:
+            samples["execution_cycles"].append(cycles)
+        if instructions is not None:
+            samples["execution_instructions"].append(instructions)
+        if cycles and instructions is not None:
+            samples["execution_ipc"].append(instructions / cycles)
+        if cache_references is not None:
+            samples["execution_cache_references"].append(cache_references)
+        if cache_misses is not None:
+            samples["execution_cache_misses"].append(cache_misses)
+        if cache_references and cache_misses is not None:
+            samples["execution_cache_miss_rate"].append(
+                100 * cache_misses / cache_references)
+        if branch_instructions is not None:
+            samples["execution_branch_instructions"].append(
+                branch_instructions)
+        if branch_misses is not None:
+            samples["execution_branch_misses"].append(branch_misses)
+        if branch_instructions and branch_misses is not None:
+            samples["execution_branch_miss_rate"].append(
+                100 * branch_misses / branch_instructions)
+
+    # per-iteration time reported by the injected timing harness,
+    # when the binary was built in harness mode
+    iteration_time = prg_monitor.iteration_time()
+    if iteration_time is not None:
+        samples["execution_iteration_time"].append(iteration_time)
+
+    # energy consumed during the run, when energy measurement is
+    # enabled and the RAPL counters are readable
+    energy = prg_monitor.energy()
+    if energy is not None:
+        samples["execution_energy"].append(energy)
+    avg_power = prg_monitor.avg_power()
+    if avg_power is not None:
+        samples["execution_avg_power"].append(avg_power)
+
+    return prg_monitor.wall_time()
+
+
+def __relative_ci(values: List[float]) -> float:
+    """Computes the relative 95% confidence interval of the given samples.
+
+    The returned value is the half-width of the confidence interval of
+    the mean (normal approximation), divided by the mean itself, so e.g.
+    0.02 means the mean is known to within plus/minus 2%.
+
+    Args:
+        values: The samples. At least two values are required.
+
+    Returns:
+        The relative confidence interval, or infinity if the mean is not
+        positive.
+    """
+
+    mean = statistics.mean(values)
+    if mean <= 0:
+        # cannot express a relative interval around a non-positive mean
+        return math.inf
+
+    # standard error of the mean
+    std_err = statistics.stdev(values) / math.sqrt(len(values))
+    # 1.96 is the 97.5 percentile of the normal distribution,
+    # giving a two-sided 95% confidence interval
+    return 1.96 * std_err / mean
+
+
+def __is_steady_state(wall_times: List[float]) -> bool:
+    """Checks whether a warmup timing sequence has reached steady state.
+
+    The sequence is considered steady when the relative spread
+    ((max - min) / min) of its last `__WARMUP_STABLE_WINDOW` values is
+    below `__WARMUP_STABLE_TOLERANCE`: the transient effects warmup
+    exists to absorb (cold page cache, branch predictor and frequency
+    ramp-up) show up as a descending head of the sequence, so a flat
+    tail means the measured samples that follow start from a warm
+    state.
+
+    Args:
+        wall_times: The warmup wall times observed so far, in order.
+
+    Returns:
+        Whether the sequence is steady. At least
+        `__WARMUP_STABLE_WINDOW` values are needed for a positive
+        answer.
+    """
+
+    if len(wall_times) < __WARMUP_STABLE_WINDOW:
+        return False
+
+    window = wall_times[-__WARMUP_STABLE_WINDOW:]
+    slowest = max(window)
+    fastest = min(window)
+    if fastest <= 0:
+        # degenerate timings (below the clock resolution): there is
+        # nothing left to warm up
+        return True
+
+    return (slowest - fastest) / fastest <= __WARMUP_STABLE_TOLERANCE
+
+
+def __format_duration(seconds: float) -> str:
+    """Formats a duration in seconds as "h:mm:ss".
+
+    Args:
+        seconds: The duration, in seconds.
+
+    Returns:
+        The formatted duration (e.g. "1:02:03").
+    """
+
+    total = round(seconds)
+    hours, rest = divmod(total, 3600)
+    minutes, secs = divmod(rest, 60)
+    return f"{hours}:{minutes:02d}:{secs:02d}"
+
+
+def analyze_unit(source_code_path: str,
+                 obf_config: Tuple[str, List[str]],
+                 runs: int,
+                 warmup: int,
+                 optimization_level: int,
+                 obf_runs: Optional[int] = None,
+                 compile_runs: Optional[int] = None,
+                 harness_iterations: Optional[int] = None
+                 ) -> Dict[str, List[Union[int, float]]]:
+    """Runs the full pipeline for a single (program, config) unit.
+
+    Unlike `perform_analysis`, no identity config is prepended and the
+    result is the raw samples of the single unit, which makes this the
+    building block for dispatching individual work units elsewhere
+    (e.g. to remote workers).
+
+    Args:
+        source_code_path: Path to the source code file.
+        obf_config: Obfuscation config.
+        runs: Number of execution runs.
+        warmup: Number of warmup runs.
+        optimization_level: Optimization level for the compiler.
+        obf_runs: Number of obfuscation runs. Optional, defaults to `runs`.
+        compile_runs: Number of compilation runs.
+            Optional, defaults to `runs`.
+        harness_iterations: Number of in-process workload iterations of
+            the injected timing harness. Optional, defaults to no
+            harness.
+
+    Returns:
+        The collected samples (dict mapping metric name to list of
+        values).
+
+    Raises:
+        OSError: If the source code file cannot be read.
+        CalledProcessError: If a command fails.
+    """
+
+    # per-phase run counts default to the execution run count
+    if obf_runs is None:
+        obf_runs = runs
+    if compile_runs is None:
+        compile_runs = runs
+
+    source_code_full_path = os.path.abspath(source_code_path)
+    source_code_filename = os.path.basename(source_code_path)
+    obf_config_filename_no_ext = \
+        os.path.splitext(os.path.basename(obf_config[0]))[0]
+
+    with tempfile.TemporaryDirectory() as unit_dir:
+        # build stage
+        _, _, samples, _ = __build_config(source_code_full_path,
+                                       source_code_filename,
+                                       obf_config_filename_no_ext,
+                                       obf_config_filename_no_ext,
+                                       unit_dir,
+                                       obf_config,
+                                       optimization_level,
+                                       obf_runs,
+                                       compile_runs,
+                                       None,
+                                       None,
+                                       None,
+                                       harness_iterations=harness_iterations)
+
+        # measure stage
+        # pre-fault the built executable into the page cache, so the
+        # first measured runs do not pay for the disk reads
+        __prefault_file(os.path.join(unit_dir, "a.out"))
+
+        # measured runs discard the program output (see `__run`),
+        # except in harness mode, where the per-iteration times are
+        # reported on stderr and must be captured
+        run_capture_policy = "capture" if harness_iterations is not None \
+                             else "discard"
+
+        for _ in range(warmup):
+            # run the program, but do not save the results
+            __run("a.out", cwd=unit_dir)
+        for _ in range(runs):
+            __measure_run(unit_dir, samples, None,
+                          capture_policy=run_capture_policy)
+
+    return samples
+
+
+def __build_config(source_code_full_path: str,
+                   source_code_filename: str,
+                   obf_config_filename_no_ext: str,
+                   unit_name: str,
+                   config_dir: str,
+                   obf_config: Tuple[str, List[str]],
+                   optimization_level: int,
+                   obf_runs: int,
+                   compile_runs: int,
+                   obf_cache: Optional[ac.ArtifactCache],
+                   compile_cache: Optional[ac.ArtifactCache],
+                   build_cpus: Optional[List[int]],
+                   ncd_compressor: str = "bz2",
+                   harness_iterations: Optional[int] = None
+                   ) -> Tuple[str, str,
+                              Dict[str, List[Union[int, float]]], str]:
+    """Builds a single (program, config) unit in its own working directory.
+
+    Runs the obfuscation and compilation phases of the analysis for the
+    given unit, leaving the compiled binary (`a.out`) in `config_dir`
+    for the execution phase, and collects the build-related metric
+    samples. Designed to be dispatched to a worker process, so it only
+    takes and returns picklable values.
+
+    Args:
+        source_code_full_path: Absolute path of the source code file.
+        source_code_filename: Filename of the source code file.
+        obf_config_filename_no_ext: Name of the obfuscation config.
+        unit_name: Name the results of this unit are keyed by.
+        config_dir: Working directory for this unit.
+        obf_config: Obfuscation config.
+        optimization_level: Optimization level for the compiler.
+        obf_runs: Number of obfuscation runs.
+        compile_runs: Number of compilation runs.
+        obf_cache: Artifact cache for the obfuscated source code. Optional.
+        compile_cache: Artifact cache for the compiled binaries. Optional.
+        build_cpus: List of CPU ids the build processes are pinned to.
+            Optional, defaults to no pinning.
+        ncd_compressor: Compressor used for the normalized compression
+            distance metric, one of `metrics.NCD_COMPRESSORS`.
+        harness_iterations: Number of in-process workload iterations of
+            the injected timing harness. Optional, defaults to no
+            harness.
+
+    Returns:
+        Tuple of the unit name, the unit working directory, the
+        collected samples (dict mapping metric name to list of values)
+        and the hash of the obfuscated output.
+
+    Raises:
+        OSError: If the source code file cannot be read.
+        CalledProcessError: If a command fails.
+    """
+
+    # get the source code filename without the extension
+    source_code_filename_no_ext = os.path.splitext(source_code_filename)[0]
+
+    # dynamically generate new source code file with the required
+    # tigress headers, depending on the obfuscation config
+    # (same filename, but stored in the config directory)
+    new_source_code_path = os.path.join(config_dir, source_code_filename)
+    __create_tigress_source_code(source_code_full_path,
+                                 new_source_code_path,
+                                 obf_config,
+                                 harness_iterations=harness_iterations)
+
+    # output obfuscated source code path
+    obf_file = os.path.join(config_dir,
+                            f"{source_code_filename_no_ext}"
+                            f"-{obf_config_filename_no_ext}.c")
+
+    # obfuscate the source code to compute the static metrics
+    # that do not change run after run
+    # (on the first run this also populates the artifact cache,
+    # so the per-run obfuscations below become cache hits)
+    __obfuscate(new_source_code_path, obf_file, obf_config,
+                cache=obf_cache, cwd=config_dir, cpu_affinity=build_cpus)
+
+    # fingerprint the obfuscated output, so the scheduler can detect
+    # configs that produce identical code for this source (e.g. a
+    # swept option that is a no-op) and share their measurements
+    with open(obf_file, 'rb') as f:
+        obf_output_hash = hashlib.sha256(f.read()).hexdigest()
+
+    # compute static metrics that do not change run after run
+    # in reality they might change, but we assume that the
+    # variability is negligible and since they are expensive
+    # to compute, we compute them only once
+    # (the compressed size of the original file is memoized inside
+    # `metrics`, so it is paid only once per campaign and per worker)
+    ncd = metrics.normalized_compression_distance(source_code_full_path,
+                                                  obf_file,
+                                                  compressor=ncd_compressor)
+    halstead_difficulty = \
+        metrics.halstead_difficulty(source_code_full_path, obf_file,
+                                    work_dir=config_dir)
+
+    # samples collected for the current config
+    # dict<metric,list<value>>
+    samples: Dict[str, List[Union[int, float]]] = defaultdict(list)
+
+    # --- obfuscation phase ---
+    for _ in range(obf_runs):
+        # obfuscate the source code (or fetch it from the cache)
+        obf_monitor = __obfuscate(new_source_code_path,
+                                  obf_file,
+                                  obf_config,
+                                  cache=obf_cache,
+                                  cwd=config_dir,
+                                  cpu_affinity=build_cpus)
+        # compile without optimizations, to be able to subtract
+        # the gcc time from the obfuscation time below
+        # (this compile exists only for the subtraction, so a cache
+        # hit replaying the recorded gcc times is always acceptable)
+        gcc1_monitor = __compile(obf_file,
+                                 optimization_level=0,
+                                 cwd=config_dir,
+                                 cpu_affinity=build_cpus,
+                                 cache=compile_cache)
+
+        # compute tigress obfuscation process related metrics;
+        # need to subtract the gcc1 times, because they are
+        # included in the obfuscation times, since the tigress
+        # obfuscation process concludes with a call to gcc;
+        # to avoid negative values, we take the max with 0
+        samples["obfuscation_wall_time"].append(
+            max(0, obf_monitor.wall_time() - gcc1_monitor.wall_time()))
+        samples["obfuscation_user_time"].append(
+            max(0, obf_monitor.user_time() - gcc1_monitor.user_time()))
+        samples["obfuscation_system_time"].append(
+            max(0, obf_monitor.system_time() - gcc1_monitor.system_time()))
+        samples["obfuscation_memory"].append(obf_monitor.max_memory())
+
+        if optimization_level == 0:
+            # no optimized compilation will be performed:
+            # the -O0 compilations double as the compile samples
+            samples["compile_wall_time"].append(gcc1_monitor.wall_time())
+            samples["compile_user_time"].append(gcc1_monitor.user_time())
+            samples["compile_system_time"].append(gcc1_monitor.system_time())
+
+    # --- compilation phase ---
+    if optimization_level > 0:
+        for _ in range(compile_runs):
+            # compile with the requested optimization level
+            # (or fetch the binary and its recorded metrics from the
+            # cache; disable the cache to collect fresh compile samples)
+            gcc2_monitor = __compile(obf_file,
+                                     optimization_level=optimization_level,
+                                     cwd=config_dir,
+                                     cpu_affinity=build_cpus,
+                                     cache=compile_cache)
+            samples["compile_wall_time"].append(gcc2_monitor.wall_time())
+            samples["compile_user_time"].append(gcc2_monitor.user_time())
+            samples["compile_system_time"].append(gcc2_monitor.system_time())
+
+    # compute the remaining static metrics
+    # (bytes to kilobytes)
+    samples["source_code_size"].append(metrics.file_size(obf_file) / 1000)
+    samples["executable_size"].append(
+        metrics.file_size(os.path.join(config_dir, "a.out")) / 1000)
+    samples["lines_of_code"].append(metrics.line_count(obf_file))
+    samples["norm_compression_distance"].append(ncd)
+    samples["halstead_difficulty"].append(halstead_difficulty)
+
+    return unit_name, config_dir, samples, obf_output_hash
+
+
 def __obfuscate(source_code_path: str,
                 obf_file_name: str,
-                obf_config: Tuple[str, List[str]]) -> rm.ResourceMonitor:
+                obf_config: Tuple[str, List[str]],
+                cache: Optional[ac.ArtifactCache] = None,
+                cwd: Optional[str] = None,
+                cpu_affinity: Optional[List[int]] = None
+                ) -> Union[rm.ResourceMonitor, ac.CachedMetrics]:
     """Obfuscates the source code using the given obfuscation config.
 
+    If an artifact cache is provided and contains an entry for the
+    (source code, config params, tigress version) triple, the cached
+    obfuscated source code is reused instead of re-invoking the
+    obfuscator, and the metrics recorded at production time are returned.
+
     Args:
         source_code_path: Path to the source code file.
         obf_file_name: Name of the (output) obfuscated source code file.
         obf_config: Obfuscation config.
+        cache: Artifact cache for the obfuscated source code. Optional.
+        cwd: Working directory for the obfuscation process. Optional.
+        cpu_affinity: List of CPU ids the obfuscation process is pinned
+            to. Optional.
 
     Returns:
-        ResourceMonitor object associated with the obfuscation process.
+        ResourceMonitor object associated with the obfuscation process,
+        or the CachedMetrics recorded when the cached artifact was
+        produced.
 
     Raises:
         CalledProcessError: If the obfuscation process fails.
     """
 
+    # compute the cache key and try the cache first
+    cache_key = None
+    if cache:
+        cache_key = cache.compute_key(source_code_path,
+                                      obf_config[1],
+                                      extra=__get_tigress_fingerprint())
+        cached_metrics = cache.lookup(cache_key, obf_file_name)
+        if cached_metrics:
+            # cache hit: the obfuscated file is already in place
+            return cached_metrics
+
     # arguments to call the obfuscator
     obf_call = list(obf_config[1])
     # add output and input files to the arguments
@@ -277,23 +1997,53 @@ def __obfuscate(source_code_path: str,
         source_code_path
     ])
     # run the obfuscator
-    obf_monitor = rm.ResourceMonitor(obf_call)
+    obf_monitor = rm.ResourceMonitor(obf_call,
+                                     cwd=cwd,
+                                     cpu_affinity=cpu_affinity)
     obf_monitor.run()
+
+    # store the artifact and its metrics in the cache
+    if cache and cache_key:
+        cache.store(cache_key,
+                    obf_file_name,
+                    { "wall_time": obf_monitor.wall_time(),
+                      "user_time": obf_monitor.user_time(),
+                      "system_time": obf_monitor.system_time(),
+                      "max_memory": obf_monitor.max_memory() })
+
     return obf_monitor
 
 
 def __compile(obf_file_name: str,
-              optimization_level: int) -> rm.ResourceMonitor:
+              optimization_level: int,
+              cwd: Optional[str] = None,
+              cpu_affinity: Optional[List[int]] = None,
+              cache: Optional[ac.ArtifactCache] = None
+              ) -> Union[rm.ResourceMonitor, ac.CachedMetrics]:
     """Compiles the obfuscated source code.
 
+    The compiled binary (`a.out`) is produced in the working directory
+    of the compilation process.
+
+    If an artifact cache is provided and contains an entry for the
+    (obfuscated source code, gcc flags, gcc version) triple, the cached
+    binary is reused instead of re-invoking the compiler, and the
+    metrics recorded at production time are returned (ccache style).
+
     Args:
         obf_file_name: Name of the obfuscated source code file.
         optimization_level: Optimization level for the compiler.
             Takes values from 0 to 3, where 0 is no optimization and
             3 is the highest optimization.
+        cwd: Working directory for the compilation process. Optional.
+        cpu_affinity: List of CPU ids the compilation process is pinned
+            to. Optional.
+        cache: Artifact cache for the compiled binary. Optional.
 
     Returns:
-        ResourceMonitor object associated with the compilation process.
+        ResourceMonitor object associated with the compilation process,
+        or the CachedMetrics recorded when the cached binary was
+        produced.
 
     Raises:
         CalledProcessError: If the compilation process fails.
@@ -303,19 +2053,73 @@ def __compile(obf_file_name: str,
     if optimization_level < 0 or optimization_level > 3:
         raise ValueError("`optimization_level` must be between 0 and 3")
 
+    # gcc produces `a.out` in its working directory
+    out_path = os.path.join(cwd, "a.out") if cwd else "a.out"
+
     # arguments to call the compiler
     gcc_call = [ "gcc", f"-O{optimization_level}", obf_file_name ]
+
+    # compute the cache key and try the cache first
+    cache_key = None
+    if cache:
+        cache_key = cache.compute_key(obf_file_name,
+                                      gcc_call[:-1],
+                                      extra=__get_gcc_fingerprint())
+        cached_metrics = cache.lookup(cache_key, out_path)
+        if cached_metrics:
+            # cache hit: the compiled binary is already in place
+            return cached_metrics
+
     # run the compiler
-    gcc_monitor = rm.ResourceMonitor(gcc_call)
+    gcc_monitor = rm.ResourceMonitor(gcc_call,
+                                     cwd=cwd,
+                                     cpu_affinity=cpu_affinity)
     gcc_monitor.run()
+
+    # store the binary and its metrics in the cache
+    if cache and cache_key:
+        cache.store(cache_key,
+                    out_path,
+                    { "wall_time": gcc_monitor.wall_time(),
+                      "user_time": gcc_monitor.user_time(),
+                      "system_time": gcc_monitor.system_time(),
+                      "max_memory": gcc_monitor.max_memory() })
+
     return gcc_monitor
 
 
-def __run(executable_name: str = "a.out") -> rm.ResourceMonitor:
+def __run(executable_name: str = "a.out",
+          cwd: Optional[str] = None,
+          cpu_affinity: Optional[List[int]] = None,
+          perf_events: Optional[List[str]] = None,
+          sample_interval: Optional[float] = None,
+          disable_aslr: bool = False,
+          capture_policy: str = "discard",
+          measure_energy: bool = False,
+          run_args: Optional[List[str]] = None) -> rm.ResourceMonitor:
     """Runs the executable.
 
     Args:
         executable_name: Name of the executable file.
+        cwd: Working directory for the execution process. Optional.
+        cpu_affinity: List of CPU ids the execution process is pinned to.
+            Optional.
+        perf_events: List of hardware event names counted during the
+            run. Optional.
+        sample_interval: Interval (in seconds) between resource usage
+            timeline samples. Optional.
+        disable_aslr: Whether to disable address space layout
+            randomization for the run. Optional.
+        capture_policy: What to do with the program output, one of
+            `rm.CAPTURE_POLICIES`. Defaults to "discard": the measured
+            programs print verification output we do not consume, and
+            storing it is work that would be billed to the measurement.
+            The tigress/gcc invocations keep capturing instead, since
+            their stderr matters for diagnostics.
+        measure_energy: Whether to read the RAPL energy counters around
+            the run. Optional.
+        run_args: Arguments passed to the executable (e.g. the problem
+            size of the current sweep step). Optional.
 
     Returns:
         ResourceMonitor object associated with the execution process.
@@ -332,75 +2136,45 @@ def __run(executable_name: str = "a.out") -> rm.ResourceMonitor:
     executable_name = os.path.join("./", executable_name)
 
     # arguments to call the executable
-    run_call = [ executable_name ]
-    run_monitor = rm.ResourceMonitor(run_call)
+    run_call = [ executable_name ] + (run_args if run_args else [])
+    run_monitor = rm.ResourceMonitor(run_call,
+                                     cwd=cwd,
+                                     cpu_affinity=cpu_affinity,
+                                     perf_events=perf_events,
+                                     sample_interval=sample_interval,
+                                     disable_aslr=disable_aslr,
+                                     capture_policy=capture_policy,
+                                     measure_energy=measure_energy)
     run_monitor.run()
     return run_monitor
 
 
-def __obfuscate_compile_run(source_code_path: str,
-                            obf_file: str,
-                            obf_config: Tuple[str, List[str]],
-                            optimization_level: int
-                            ) -> Tuple[rm.ResourceMonitor,
-                                       rm.ResourceMonitor,
-                                       rm.ResourceMonitor,
-                                       rm.ResourceMonitor]:
-    """Obfuscates, compiles and runs the source code.
-
-    Args:
-        source_code_path: Path to the source code file.
-        obf_file: Name of the (output) obfuscated source code file.
-        obf_config: Obfuscation config.
-        optimization_level: Optimization level for the compiler.
-            Takes values from 0 to 3, where 0 is no optimization and
-            3 is the highest optimization.
-
-    Returns:
-        Tuple of four ResourceMonitor objects associated with the obfuscation,
-        compilation (without optimization), compilation (with optimization),
-        and execution processes.
-        If `optimization_level` is 0, the third and fourth elements of the
-        tuple are the same.
-
-    Raises:
-        CalledProcessError: If any of the processes fails.
-    """
-
-    # obfuscate source code
-    obf_monitor = __obfuscate(source_code_path, obf_file, obf_config)
-
-    # compile obfuscated code (without optimizations)
-    gcc1_monitor = __compile(obf_file, optimization_level=0)
-
-    # compile obfuscated code (with optimizations) if required
-    if optimization_level > 0:
-        gcc2_monitor = __compile(obf_file,
-                                 optimization_level=optimization_level)
-    else:
-        # if no optimizations are required, use the same monitor
-        # as for the compilation without optimizations
-        gcc2_monitor = gcc1_monitor
-
-    # run obfuscated program
-    prg_monitor = __run("a.out")
-
-    return obf_monitor, gcc1_monitor, gcc2_monitor, prg_monitor
-
-
 def __create_tigress_source_code(source_code_path: str,
                                  new_source_code_path: str,
-                                 obf_config: Tuple[str, List[str]]) -> None:
+                                 obf_config: Tuple[str, List[str]],
+                                 harness_iterations: Optional[int] = None
+                                 ) -> None:
     """Creates a new source code file, with the required tigress headers.
 
     Creates a new source code file, that includes in the original
     source code file the required tigress header files, depending on the
     obfuscation configuration.
 
+    When `harness_iterations` is given, the in-process timing harness is
+    additionally injected: the original `main` is renamed with a
+    `#define` and a new `main` is appended that runs it
+    `harness_iterations` times around `clock_gettime` and reports the
+    average per-iteration nanoseconds on stderr. Since the harness is
+    part of the generated source, it goes through the obfuscation like
+    the rest of the program (`--Functions=*` configs transform it too),
+    but the measured region stays the workload iterations only.
+
     Args:
         source_code_path: Path to the source code file.
         new_source_code_path: Path to the new source code file.
         obf_config: Obfuscation config.
+        harness_iterations: Number of in-process workload iterations of
+            the timing harness. Optional, defaults to no harness.
 
     Raises:
         OSError: If the source code file cannot be opened.
@@ -416,8 +2190,98 @@ def __create_tigress_source_code(source_code_path: str,
          open(new_source_code_path, 'w') as dst:
         # write the include lines
         dst.writelines(header_lines)
+        if harness_iterations is not None:
+            # rename the original `main` out of the way, so the harness
+            # appended below becomes the entry point
+            # (the rename breaks `int main(void)` definitions, since the
+            # harness calls the workload with (argc, argv); use
+            # `int main()` or `int main(int, char**)` in harness mode)
+            dst.write("#define main __obf_perf_wrapped_main\n")
         # write the original source code
         dst.write(src.read())
+        if harness_iterations is not None:
+            # append the timing harness
+            dst.write(__TIMING_HARNESS_TEMPLATE.format(
+                iterations=harness_iterations,
+                marker=rm.ITERATION_TIME_MARKER))
+
+
+def __cpu_model() -> str:
+    """Returns the CPU model name of the local machine.
+
+    Returns:
+        The "model name" entry of /proc/cpuinfo, or "unknown" when it
+        cannot be determined.
+    """
+
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    return line.split(":", maxsplit=1)[-1].strip()
+    except OSError:
+        pass
+
+    return "unknown"
+
+
+def __current_governors() -> str:
+    """Returns the set of cpufreq governors currently in effect.
+
+    Returns:
+        The comma-separated sorted set of governors (normally a single
+        one), or "unavailable" when the machine exposes no cpufreq
+        interface.
+    """
+
+    governors = set()
+    for governor_path in glob.glob(
+            "/sys/devices/system/cpu/cpu[0-9]*/cpufreq/scaling_governor"):
+        try:
+            with open(governor_path) as f:
+                governors.add(f.read().strip())
+        except OSError:
+            pass
+
+    return ",".join(sorted(governors)) if governors else "unavailable"
+
+
+def __get_tigress_fingerprint() -> str:
+    """Gets the tigress version fingerprint, used to key the artifact cache.
+
+    The fingerprint is computed once and memoized, since it cannot change
+    during an analysis.
+
+    Returns:
+        The tigress version fingerprint.
+    """
+
+    global __tigress_fingerprint
+
+    # compute the fingerprint only once
+    if __tigress_fingerprint is None:
+        __tigress_fingerprint = ac.tool_fingerprint("tigress")
+
+    return __tigress_fingerprint
+
+
+def __get_gcc_fingerprint() -> str:
+    """Gets the gcc version fingerprint, used to key the compile cache.
+
+    The fingerprint is computed once and memoized, since it cannot change
+    during an analysis.
+
+    Returns:
+        The gcc version fingerprint.
+    """
+
+    global __gcc_fingerprint
+
+    # compute the fingerprint only once
+    if __gcc_fingerprint is None:
+        __gcc_fingerprint = ac.tool_fingerprint("gcc")
+
+    return __gcc_fingerprint
 
 
 # get header files required by the obfuscation configuration
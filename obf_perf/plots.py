@@ -6,6 +6,12 @@ Functions:
         and a red line that passes through the averages of the various
         data.
     grouped_bar_plot: Generate a grouped bar plot with the given data.
+    time_series_plot: Generate a plot of time series (one or more runs
+        per label) with the given data.
+    scaling_plot: Generate a log-log plot of value versus input size,
+        fitting the scaling exponent of each label.
+    render_plot: Render one plot by function name, for use from a
+        process pool.
 
 Typical usage example:
     import plots
@@ -33,8 +39,13 @@ Typical usage example:
 """
 
 
+import math
 from typing import Dict, List, Optional, Tuple
 
+import matplotlib
+# render off-screen: the Agg backend needs no display, keeps no
+# interactive state, and is safe to use from worker processes
+matplotlib.use("Agg")
 import matplotlib.pyplot as plt
 
 
@@ -42,6 +53,25 @@ import matplotlib.pyplot as plt
 plt.rcParams.update({ 'font.size': 16 })
 
 
+def render_plot(plot_function_name: str, *args) -> None:
+    """Renders one plot, discarding the figure.
+
+    Entry point for rendering plots on a process pool: the caller
+    ships the plot function name and its (picklable) data arguments,
+    the worker draws and saves the plot, and nothing is returned, so
+    no figure ever crosses the process boundary.
+
+    Args:
+        plot_function_name: Name of the plot function of this module
+            to call (e.g. "violin_plot_with_avg").
+        *args: Arguments forwarded to the plot function; the output
+            filename must be included, since the saved file is the
+            only result.
+    """
+
+    globals()[plot_function_name](*args)
+
+
 def violin_plot(data_dict: Dict[str, List[float]],
                 title: str,
                 y_label: str,
@@ -79,8 +109,12 @@ def violin_plot(data_dict: Dict[str, List[float]],
     ax.set_ylabel(y_label)
     ax.set_xticks(range(1, len(labels)+1), labels, rotation=45)
 
-    # save the plot if an output filename is provided
-    if out_filename: plt.savefig(out_filename)
+    # save the plot if an output filename is provided, then close the
+    # figure to release its memory (matplotlib keeps every figure
+    # alive until it is explicitly closed)
+    if out_filename:
+        fig.savefig(out_filename)
+        plt.close(fig)
 
     return fig, ax
 
@@ -117,8 +151,147 @@ def violin_plot_with_avg(data_dict: Dict[str, List[float]],
     # plot the average line
     ax.plot(range(1, len(labels)+1), avg_data, color="red")
 
-    # save the plot if an output filename is provided
-    if out_filename: plt.savefig(out_filename)
+    # save the plot if an output filename is provided, then close the
+    # figure to release its memory (matplotlib keeps every figure
+    # alive until it is explicitly closed)
+    if out_filename:
+        fig.savefig(out_filename)
+        plt.close(fig)
+
+    return fig, ax
+
+
+def time_series_plot(series_dict: Dict[str, List[List[Tuple[float, float]]]],
+                     title: str,
+                     y_label: str,
+                     out_filename: Optional[str] = None
+                     ) -> Tuple[plt.Figure, plt.Axes]:
+    """Generates a plot of time series with the given data.
+
+    Each label can have multiple series (e.g. one per measured run):
+    all the series of a label are drawn in the same color, so the
+    between-run variability is visible without cluttering the legend.
+
+    Args:
+        series_dict: Dictionary mapping labels to lists of series,
+            each series being a list of (time, value) samples.
+        title: Title of the plot.
+        y_label: Label of the y axis.
+        out_filename: Path of the file where to save the plot.
+            Optional, if not provided the plot is not saved.
+
+    Returns:
+        The figure and the axis of the plot.
+    """
+
+    fig, ax = plt.subplots(nrows=1,
+                           ncols=1,
+                           figsize=(20,10),
+                           tight_layout=True)
+
+    # plot the series of each label
+    for i, (label, series_list) in enumerate(series_dict.items()):
+        # one color per label, cycling through the default color cycle
+        color = f"C{i % 10}"
+        for j, series in enumerate(series_list):
+            if not series:
+                # no samples (e.g. the run was too short): skip
+                continue
+            times = [ sample[0] for sample in series ]
+            values = [ sample[1] for sample in series ]
+            # attach the legend label only to the first series
+            ax.plot(times,
+                    values,
+                    color=color,
+                    alpha=0.8,
+                    label=label if j == 0 else None)
+
+    # customize the plot
+    ax.set_title(title)
+    ax.set_xlabel("Time (s)")
+    ax.set_ylabel(y_label)
+    ax.legend(loc="upper left")
+
+    # save the plot if an output filename is provided, then close the
+    # figure to release its memory (matplotlib keeps every figure
+    # alive until it is explicitly closed)
+    if out_filename:
+        fig.savefig(out_filename)
+        plt.close(fig)
+
+    return fig, ax
+
+
+def scaling_plot(data_dict: Dict[str, List[Tuple[float, float]]],
+                 title: str,
+                 y_label: str,
+                 out_filename: Optional[str] = None
+                 ) -> Tuple[plt.Figure, plt.Axes]:
+    """Generates a log-log scaling plot with the given data.
+
+    Each label has a list of (input size, value) points; the points are
+    drawn on log-log axes and a power law `value = c * size^k` is
+    fitted per label (least squares in log-log space), with the scaling
+    exponent `k` displayed in the legend. Parallel lines then mean a
+    constant-factor overhead, while a steeper line means overhead that
+    grows with the data size.
+
+    Args:
+        data_dict: Dictionary mapping labels to lists of
+            (input size, value) points.
+        title: Title of the plot.
+        y_label: Label of the y axis.
+        out_filename: Path of the file where to save the plot.
+            Optional, if not provided the plot is not saved.
+
+    Returns:
+        The figure and the axis of the plot.
+    """
+
+    fig, ax = plt.subplots(nrows=1,
+                           ncols=1,
+                           figsize=(20,10),
+                           tight_layout=True)
+
+    for label, points in data_dict.items():
+        # sort by input size and keep only points a log can be taken of
+        points = sorted(point for point in points
+                        if point[0] > 0 and point[1] > 0)
+        if not points:
+            continue
+        sizes = [ point[0] for point in points ]
+        values = [ point[1] for point in points ]
+
+        # fit the scaling exponent: least squares slope in log-log space
+        legend_label = label
+        if len(points) >= 2:
+            log_sizes = [ math.log(size) for size in sizes ]
+            log_values = [ math.log(value) for value in values ]
+            mean_x = sum(log_sizes) / len(log_sizes)
+            mean_y = sum(log_values) / len(log_values)
+            var_x = sum((x - mean_x) ** 2 for x in log_sizes)
+            if var_x > 0:
+                cov_xy = sum((x - mean_x) * (y - mean_y)
+                             for x, y in zip(log_sizes, log_values))
+                exponent = cov_xy / var_x
+                legend_label = f"{label} (k={exponent:.2f})"
+
+        ax.plot(sizes, values, marker="o", label=legend_label)
+
+    # customize the plot
+    ax.set_xscale("log")
+    ax.set_yscale("log")
+    ax.set_title(title)
+    ax.set_xlabel("Input size")
+    ax.set_ylabel(y_label)
+    ax.legend(loc="upper left")
+
+    # save the plot if an output filename is provided, then close the
+    # figure to release its memory (matplotlib keeps every figure
+    # alive until it is explicitly closed)
+    if out_filename:
+        fig.savefig(out_filename)
+        plt.close(fig)
 
     return fig, ax
 
@@ -201,7 +374,11 @@ def grouped_bar_plot(data_dict_by_group: Dict[str,Dict[str, List[float]]],
     ax.set_ylim(top=top_lim + 0.15 * top_lim)
     ax.legend(loc="upper left")
 
-    # save the plot if an output filename is provided
-    if out_filename: plt.savefig(out_filename)
+    # save the plot if an output filename is provided, then close the
+    # figure to release its memory (matplotlib keeps every figure
+    # alive until it is explicitly closed)
+    if out_filename:
+        fig.savefig(out_filename)
+        plt.close(fig)
 
     return fig, ax
@@ -0,0 +1,279 @@
+"""Distributed execution of the analysis across benchmark machines.
+
+This module provides a coordinator/worker mode for the analysis: the
+coordinator dispatches (program, config) work units to remote workers
+over SSH, each worker runs the obfuscate/compile/measure pipeline for
+its unit and sends the collected samples back, and the coordinator
+merges them into a single `ResultContainer`.
+
+A remote worker machine must have obf-perf available on its
+`PYTHONPATH` (plus tigress, gcc and ctags installed); the coordinator
+invokes `python3 -m obf_perf.remote` on it and exchanges JSON over the
+SSH stdin/stdout channel. The tigress-specific source code rewriting
+happens on the worker, so each machine uses its own `TIGRESS_HOME`.
+
+Since numbers measured on different hardware are not comparable, the
+coordinator refuses to dispatch work unless all the workers report the
+same CPU model as the local machine.
+
+Typical usage example:
+    import obf_perf.remote as remote
+
+    results = remote.perform_distributed_analysis(
+        ["source_code.c"],
+        obf_configs,
+        hosts=["worker1", "worker2"],
+        runs=10,
+        warmup=3,
+        optimization_level=3)
+"""
+
+
+import json
+import os
+import subprocess
+import sys
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+from queue import Queue
+from typing import Callable, Dict, List, Optional, Tuple, Union
+
+import obf_perf.obf_perf_core as opcore
+import obf_perf.result_container as rc
+
+
+def perform_distributed_analysis(source_code_paths: List[str],
+                                 obf_configs: List[Tuple[str, List[str]]],
+                                 hosts: List[str],
+                                 runs: int,
+                                 warmup: int,
+                                 optimization_level: int,
+                                 obf_runs: Optional[int] = None,
+                                 compile_runs: Optional[int] = None,
+                                 harness_iterations: Optional[int] = None,
+                                 step_callback: Optional[Callable] = None
+                                 ) -> rc.ResultContainer:
+    """Performs the analysis dispatching work units to remote workers.
+
+    The (program, config) matrix is enumerated exactly like in
+    `perform_analysis`, and each unit is dispatched to the next free
+    worker over SSH. The returned samples are merged into one
+    `ResultContainer`, keyed like the local analysis.
+
+    Args:
+        source_code_paths: Paths to the source code files.
+        obf_configs: List of obfuscation configs, as returned by
+            `load_obfuscation_configs`.
+        hosts: SSH destinations of the worker machines
+            (e.g. "user@host").
+        runs: Number of execution runs for each unit.
+        warmup: Number of warmup runs for each unit.
+        optimization_level: Optimization level for the compiler.
+        obf_runs: Number of obfuscation runs. Optional, defaults to `runs`.
+        compile_runs: Number of compilation runs.
+            Optional, defaults to `runs`.
+        harness_iterations: Number of in-process workload iterations of
+            the injected timing harness. Optional, defaults to no
+            harness.
+        step_callback: Callback function to be called after each
+            completed unit.
+
+    Returns:
+        ResultContainer containing the results of the analysis.
+
+    Raises:
+        RuntimeError: If the worker pool is not homogeneous with the
+            local machine, or a worker fails.
+        OSError: If a source code file cannot be read.
+    """
+
+    if len(hosts) < 1:
+        raise ValueError("`hosts` must contain at least one worker")
+
+    # refuse to merge numbers measured on different hardware
+    ensure_homogeneous(hosts)
+
+    # enumerate the work units like the local analysis does
+    # (`load_obfuscation_configs` already prepended the identity config)
+    multi_program = len(source_code_paths) > 1
+    # list[(unit_name, payload)]
+    units = []
+    for source_code_path in source_code_paths:
+        # the worker regenerates the tigress headers with its own
+        # TIGRESS_HOME, so the original source content is shipped
+        with open(source_code_path) as f:
+            source_content = f.read()
+        source_name = os.path.basename(source_code_path)
+        source_name_no_ext = os.path.splitext(source_name)[0]
+
+        for obf_config in obf_configs:
+            config_name_no_ext = \
+                os.path.splitext(os.path.basename(obf_config[0]))[0]
+            unit_name = f"{source_name_no_ext}:{config_name_no_ext}" \
+                        if multi_program else config_name_no_ext
+
+            units.append((unit_name,
+                          { "source_name": source_name,
+                            "source_content": source_content,
+                            "config_name": obf_config[0],
+                            "config_params": obf_config[1],
+                            "runs": runs,
+                            "warmup": warmup,
+                            "optimization_level": optimization_level,
+                            "obf_runs": obf_runs,
+                            "compile_runs": compile_runs,
+                            "harness_iterations": harness_iterations }))
+
+    # queue of units to dispatch; each worker thread pops from it,
+    # so the matrix is load-balanced across the pool
+    unit_queue: Queue = Queue()
+    for unit in units:
+        unit_queue.put(unit)
+
+    # samples returned for each unit
+    measured_samples: Dict[str, Dict[str, List[Union[int, float]]]] = {}
+
+    def worker_loop(host: str) -> None:
+        """Dispatches units to a single worker until the queue is empty."""
+        while True:
+            try:
+                unit_name, payload = unit_queue.get_nowait()
+            except Exception:
+                # queue empty: this worker is done
+                return
+            measured_samples[unit_name] = run_unit_on_worker(host, payload)
+            if step_callback: step_callback()
+
+    # one dispatcher thread per worker (the work itself happens
+    # remotely, the threads only wait on SSH)
+    with ThreadPoolExecutor(max_workers=len(hosts)) as pool:
+        futures = [ pool.submit(worker_loop, host) for host in hosts ]
+        for future in futures:
+            # propagate worker failures
+            future.result()
+
+    # merge the samples into the result container, in unit order
+    results = rc.ResultContainer()
+    for unit_name, _ in units:
+        for metric_name, values in measured_samples[unit_name].items():
+            results.add_metric_samples(unit_name, metric_name, values)
+
+    return results
+
+
+def run_unit_on_worker(host: str,
+                       payload: Dict) -> Dict[str, List[Union[int, float]]]:
+    """Runs a single work unit on a remote worker.
+
+    Args:
+        host: SSH destination of the worker machine.
+        payload: Work unit description (see
+            `perform_distributed_analysis`).
+
+    Returns:
+        The samples collected by the worker (dict mapping metric name to
+        list of values).
+
+    Raises:
+        RuntimeError: If the worker fails.
+    """
+
+    proc = subprocess.run(
+        [ "ssh", host, "python3", "-m", "obf_perf.remote", "--worker" ],
+        input=json.dumps(payload),
+        text=True,
+        capture_output=True)
+
+    if proc.returncode != 0:
+        raise RuntimeError(f"worker '{host}' failed:\n{proc.stderr}")
+
+    try:
+        return json.loads(proc.stdout)
+    except ValueError:
+        raise RuntimeError(f"worker '{host}' returned malformed output:\n"
+                           f"{proc.stdout}")
+
+
+def ensure_homogeneous(hosts: List[str]) -> None:
+    """Checks that all the workers have the same CPU model as the local
+    machine.
+
+    Args:
+        hosts: SSH destinations of the worker machines.
+
+    Raises:
+        RuntimeError: If a worker reports a different CPU model, or the
+            model cannot be determined.
+    """
+
+    local_model = __local_cpu_model()
+
+    for host in hosts:
+        proc = subprocess.run(
+            [ "ssh", host,
+              "grep", "-m1", "'model name'", "/proc/cpuinfo" ],
+            text=True,
+            capture_output=True)
+        if proc.returncode != 0:
+            raise RuntimeError(f"cannot query CPU model of worker"
+                               f" '{host}':\n{proc.stderr}")
+
+        remote_model = proc.stdout.split(":", maxsplit=1)[-1].strip()
+        if remote_model != local_model:
+            raise RuntimeError(
+                f"worker pool is not homogeneous: '{host}' has CPU"
+                f" '{remote_model}', the local machine has"
+                f" '{local_model}'; refusing to merge results measured"
+                f" on different hardware")
+
+
+def __local_cpu_model() -> str:
+    """Returns the CPU model of the local machine."""
+
+    with open("/proc/cpuinfo") as f:
+        for line in f:
+            if line.startswith("model name"):
+                return line.split(":", maxsplit=1)[-1].strip()
+
+    raise RuntimeError("cannot determine the local CPU model")
+
+
+def __worker_main() -> int:
+    """Worker entry point: runs one unit read from stdin.
+
+    Reads the work unit payload as JSON from stdin, runs the pipeline
+    for it and writes the collected samples as JSON to stdout.
+
+    Returns:
+        The process exit code.
+    """
+
+    payload = json.load(sys.stdin)
+
+    # write the shipped source in a scratch directory, then run the
+    # regular single-unit pipeline on it
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        source_path = os.path.join(tmp_dir, payload["source_name"])
+        with open(source_path, 'w') as f:
+            f.write(payload["source_content"])
+
+        samples = opcore.analyze_unit(
+            source_path,
+            (payload["config_name"], payload["config_params"]),
+            runs=payload["runs"],
+            warmup=payload["warmup"],
+            optimization_level=payload["optimization_level"],
+            obf_runs=payload["obf_runs"],
+            compile_runs=payload["compile_runs"],
+            # absent when the coordinator runs an older obf-perf
+            harness_iterations=payload.get("harness_iterations"))
+
+    json.dump(samples, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    if "--worker" in sys.argv:
+        sys.exit(__worker_main())
+    print("usage: python3 -m obf_perf.remote --worker", file=sys.stderr)
+    sys.exit(2)
@@ -1,7 +1,9 @@
 """Resource monitor for a process.
 
 This module provides a class to run a process and monitor its resource usage.
-It requires that `/usr/bin/time` is installed.
+The process is spawned directly with `posix_spawn` and the resource usage
+is taken from the `wait4` rusage, so no wrapper process or pipe traffic is
+added to the measurement.
 
 Typical usage example:
     import resource_monitor as rm
@@ -23,10 +25,34 @@ Typical usage example:
 """
 
 
+import glob
 import os
+import tempfile
+import threading
 import time
 import subprocess
-from typing import List
+from typing import Dict, List, Optional, Tuple
+
+
+# interval between peak memory samples of the running process, in seconds
+MEMORY_SAMPLE_INTERVAL = 0.001
+
+# prefix of the stderr line on which the injected in-process timing
+# harness reports the average per-iteration nanoseconds
+ITERATION_TIME_MARKER = "OBF_PERF_ITER_NS="
+
+# sysfs directory of the RAPL (Running Average Power Limit) energy
+# counters, used for the per-run energy measurement
+RAPL_DIR = "/sys/class/powercap"
+
+# supported output capture policies:
+# - "capture": the output is captured and available via
+#   `stdout()`/`stderr()`
+# - "discard": the output is redirected to /dev/null; the cheapest
+#   policy for measured runs of programs with heavy output
+# - "spill": the output is written to named temporary files on disk,
+#   and only read into memory if `stdout()`/`stderr()` is called
+CAPTURE_POLICIES = [ "capture", "discard", "spill" ]
 
 
 class ResourceMonitor:
@@ -38,19 +64,61 @@ class ResourceMonitor:
     # - _resource_usage (resource.struct_rusage): the resource usage
     # - _wall_time (float): the wall clock time
     #   since resource.struct_rusage does not include it
-    # - _max_memory (int): the maximum memory usage
-    #   since resource.struct_rusage one is not precise due to
-    #   how linux kernel process creation works (fork + exec)
+    # - _max_memory (int): the maximum memory usage, from ru_maxrss
     # - _stdout (str): the stdout of the process
+    #   (read lazily from _stdout_path with the "spill" policy)
     # - _stderr (str): the stderr of the process
-
-    def __init__(self, args: List[str], check: bool = True):
+    # - _stdout_path (str): path of the spilled stdout file,
+    #   when the "spill" policy is used
+    # - _stderr_path (str): path of the spilled stderr file,
+    #   when the "spill" policy is used
+    # - _perf_counters (Dict[str, float]): the hardware performance
+    #   counters, when perf events were requested
+    # - _timeline (List[Tuple[float, int, float]]): the resource usage
+    #   timeline, when timeline sampling was requested
+
+    def __init__(self,
+                 args: List[str],
+                 check: bool = True,
+                 cwd: Optional[str] = None,
+                 cpu_affinity: Optional[List[int]] = None,
+                 capture_policy: str = "capture",
+                 perf_events: Optional[List[str]] = None,
+                 sample_interval: Optional[float] = None,
+                 disable_aslr: bool = False,
+                 measure_energy: bool = False):
         """Initializes the resource monitor.
 
         Args:
             args: The command to run.
             check: Whether to raise an error if the command exits with
                 a non-zero exit status code.
+            cwd: Working directory for the process.
+                Optional, defaults to the current working directory.
+            cpu_affinity: List of CPU ids the process is pinned to.
+                Optional, defaults to no pinning.
+            capture_policy: What to do with the stdout and stderr of
+                the process, one of `CAPTURE_POLICIES`: "capture"
+                (default) makes them available via
+                `stdout()`/`stderr()`, "discard" redirects them to
+                `/dev/null` (the accessors return the empty string),
+                "spill" writes them to named temporary files that are
+                only read into memory on access (see `stdout_path()`).
+            perf_events: List of hardware event names (e.g. "cycles",
+                "cache-misses") to count during the run with
+                `perf stat`. Optional, defaults to no counters.
+                Requires that `perf` is installed.
+            sample_interval: Interval (in seconds) between resource
+                usage timeline samples, see `timeline()`. Optional,
+                defaults to no timeline sampling.
+            disable_aslr: Whether to disable address space layout
+                randomization for the process (via `setarch -R`), so
+                the memory layout is identical run after run. Requires
+                that `setarch` (util-linux) is installed.
+            measure_energy: Whether to read the RAPL energy counters
+                around the process lifetime, see `energy()`. Requires
+                read access to the RAPL sysfs counters (root on most
+                machines), see `rapl_available()`.
         """
 
         # validate args
@@ -60,6 +128,21 @@ class ResourceMonitor:
         # copy args
         self._args = args.copy()
         self._check = check
+        self._cwd = cwd
+        self._cpu_affinity = list(cpu_affinity) if cpu_affinity else None
+        if capture_policy not in CAPTURE_POLICIES:
+            raise ValueError(f"`capture_policy` must be one of"
+                             f" {CAPTURE_POLICIES}")
+        self._capture_policy = capture_policy
+        self._stdout_path: Optional[str] = None
+        self._stderr_path: Optional[str] = None
+        self._perf_events = list(perf_events) if perf_events else None
+        self._perf_counters: Dict[str, float] = {}
+        self._sample_interval = sample_interval
+        self._timeline: List[Tuple[float, int, float]] = []
+        self._disable_aslr = disable_aslr
+        self._measure_energy = measure_energy
+        self._energy: Optional[float] = None
         # set as not run
         self._run = False
 
@@ -67,8 +150,6 @@ class ResourceMonitor:
     def run(self) -> int:
         """Runs the process and monitors its resource usage.
 
-        Requires that `/usr/bin/time` is installed.
-
         Returns:
             The exit status code of the process.
 
@@ -77,58 +158,210 @@ class ResourceMonitor:
                 exit status code and `check` is `True`.
         """
 
-        # extended args for precise memory usage monitoring
-        # with `/usr/bin/time`
-        # the one in the resource.struct_rusage is not precise
-        # due to how linux kernel process creation works (fork + exec)
-        # when forking, the memory usage is preserved, so the
-        # memory usage of the child process is the same as the parent
-        # if the child process does not allocate more memory
-
-        # time -f "\n%M" <command> runs <command> and prints
-        # the maximum memory usage to stderr on a new line
-        args = ["/usr/bin/time", "-f", "\n%M"] + self._args
-
-        # start timer for wall clock time
-        start = time.perf_counter()
-        # run the process, capturing both stdout and stderr
-        p = subprocess.Popen(args,
-                             stdout=subprocess.PIPE,
-                             stderr=subprocess.PIPE)
-
-        # read stdout and stderr
-        stdout_data = p.stdout.read() # type: ignore
-        stderr_data = p.stderr.read() # type: ignore
-
-        # wait for process termination and
-        # get exit status code and resource usage
-        _, status, resource_usage = os.wait4(p.pid, 0)
-
-        # stop timer for wall clock time
-        end = time.perf_counter()
+        # the process is spawned directly with `posix_spawn`: on linux
+        # (glibc) it is implemented with vfork semantics, so the child
+        # does not inherit a copy-on-write image of this (large) python
+        # process and its ru_maxrss reflects its own memory usage;
+        # this replaces the previous `/usr/bin/time` wrapper, which
+        # added a whole extra fork/exec to every measurement
+
+        # when perf events are requested, the command is wrapped in
+        # `perf stat`, which opens the counters on the child before
+        # exec'ing it and writes the counts to a file on exit
+        # (counting mode adds no measurable overhead to the run itself,
+        # but the wait4 rusage then includes perf's own small footprint)
+        args = self._args
+        perf_out_path = None
+        if self._perf_events:
+            perf_out_fd, perf_out_path = tempfile.mkstemp(suffix=".perf")
+            os.close(perf_out_fd)
+            args = [ "perf", "stat",
+                     "-x", ",",
+                     "-o", perf_out_path,
+                     "-e", ",".join(self._perf_events),
+                     "--" ] + args
+
+        # when ASLR is disabled, the command is wrapped (outermost) in
+        # `setarch -R`, which clears the randomization personality flag
+        # and then exec's the command, so no extra process outlives the
+        # spawn and the monitored pid stays the target's
+        if self._disable_aslr:
+            args = [ "setarch", "-R" ] + args
+
+        # the output goes to temporary files (or /dev/null) instead of
+        # pipes: a pipe must be drained while the child runs, which
+        # either deadlocks on chatty programs or adds reader overhead
+        # to the measurement
+        if self._capture_policy == "capture":
+            stdout_file = tempfile.TemporaryFile()
+            stderr_file = tempfile.TemporaryFile()
+        elif self._capture_policy == "spill":
+            # named files that outlive the run; only read into memory
+            # if the output is actually accessed
+            stdout_file = tempfile.NamedTemporaryFile(suffix=".stdout",
+                                                      delete=False)
+            stderr_file = tempfile.NamedTemporaryFile(suffix=".stderr",
+                                                      delete=False)
+            self._stdout_path = stdout_file.name
+            self._stderr_path = stderr_file.name
+        else:
+            stdout_file = open(os.devnull, 'wb')
+            stderr_file = open(os.devnull, 'wb')
+
+        with stdout_file, stderr_file:
+            # redirect the child's stdout and stderr
+            file_actions = [
+                (os.POSIX_SPAWN_DUP2, stdout_file.fileno(), 1),
+                (os.POSIX_SPAWN_DUP2, stderr_file.fileno(), 2)
+            ]
+
+            # the working directory and the CPU affinity are inherited
+            # by the spawned child, so they are set in this process
+            # right before the spawn and restored right after
+            old_cwd = os.getcwd() if self._cwd else None
+            old_affinity = os.sched_getaffinity(0) \
+                           if self._cpu_affinity else None
+
+            try:
+                if self._cwd:
+                    os.chdir(self._cwd)
+                if self._cpu_affinity:
+                    os.sched_setaffinity(0, set(self._cpu_affinity))
+
+                # snapshot the RAPL energy counters right before the
+                # spawn; the counters are socket-wide, so the delta also
+                # includes whatever else runs during the measurement
+                energy_before = _read_rapl_energy() \
+                                if self._measure_energy else None
+
+                # start timer for wall clock time
+                start = time.perf_counter()
+                # spawn the process (searching the executable in PATH)
+                pid = os.posix_spawnp(args[0],
+                                      args,
+                                      dict(os.environ),
+                                      file_actions=file_actions)
+            finally:
+                # restore the working directory and the CPU affinity
+                # (the child keeps the values it inherited at spawn)
+                if old_cwd is not None:
+                    os.chdir(old_cwd)
+                if old_affinity is not None:
+                    os.sched_setaffinity(0, old_affinity)
+
+            # sample the peak memory (VmHWM) of the child from /proc
+            # while it runs, in a background thread so the wait below
+            # reaps the child the moment it exits:
+            # the ru_maxrss reported by wait4 is a per-task high-water
+            # mark that is not reset across execve, so a child of this
+            # (large) python process reports at least the python RSS;
+            # VmHWM instead belongs to the post-exec address space and
+            # reflects the child's own memory usage
+            # (posix_spawn blocks until the child has exec'd, so the
+            # samples never see the pre-exec address space)
+            # (when the command is wrapped in perf, the sampler follows
+            # perf's child, so the reported memory is still the target's)
+            # (the same thread also records the resource usage timeline,
+            # when timeline sampling is requested)
+            peak_memory = [ 0 ]
+            stop_sampling = threading.Event()
+            sampler = threading.Thread(target=_sample_process,
+                                       args=(pid,
+                                             peak_memory,
+                                             stop_sampling,
+                                             perf_out_path is not None,
+                                             self._sample_interval,
+                                             self._timeline),
+                                       daemon=True)
+            sampler.start()
+
+            # wait for process termination and
+            # get exit status code and resource usage
+            _, wait_status, resource_usage = os.wait4(pid, 0)
+
+            # stop timer for wall clock time
+            end = time.perf_counter()
+
+            # snapshot the RAPL energy counters right after the child
+            # has been reaped
+            energy_after = _read_rapl_energy() \
+                           if self._measure_energy else None
+
+            # stop the memory sampler
+            stop_sampling.set()
+            sampler.join()
+
+            # decode the wait status into an exit status code
+            # (negative for termination by signal)
+            status = os.waitstatus_to_exitcode(wait_status)
+
+            # read back the captured output
+            # (spilled output stays on disk and is read lazily by the
+            # accessors, discarded output is gone)
+            if self._capture_policy == "capture":
+                stdout_file.seek(0)
+                stderr_file.seek(0)
+                stdout_data = stdout_file.read()
+                stderr_data = stderr_file.read()
+            else:
+                stdout_data = b""
+                stderr_data = b""
 
         # check exit status code and raise error if necessary
         if self._check and status != 0:
+            if self._capture_policy == "spill" and self._stderr_path:
+                # include the spilled stderr in the diagnostics
+                with open(self._stderr_path, 'rb') as f:
+                    stderr_data = f.read()
             raise subprocess.CalledProcessError(status,
-                                                args,
+                                                self._args,
                                                 stdout_data,
                                                 stderr_data)
 
         # store wall clock time
         self._wall_time = end - start
 
+        # store the energy consumed during the run, summed over the
+        # RAPL domains (handling counter wraparound per domain)
+        if energy_before and energy_after:
+            total_uj = 0
+            for domain, (before_uj, max_range_uj) in energy_before.items():
+                if domain not in energy_after:
+                    continue
+                delta_uj = energy_after[domain][0] - before_uj
+                if delta_uj < 0 and max_range_uj:
+                    # the counter wrapped around during the run
+                    delta_uj += max_range_uj
+                total_uj += delta_uj
+            # microjoules to joules
+            self._energy = total_uj / 1e6
+
         # store resource usage
         self._resource_usage = resource_usage
 
-        # decode and store stdout and stderr
-        self._stdout = stdout_data.decode("utf-8")
-        self._stderr = stderr_data.decode("utf-8")
+        # store the maximum memory usage: the sampled VmHWM peak when
+        # available, the (possibly inflated, see above) ru_maxrss as a
+        # fallback for processes that exit before the first sample
+        # (both are in KB)
+        self._max_memory = peak_memory[0] if peak_memory[0] > 0 \
+                           else resource_usage.ru_maxrss
 
-        # get memory usage from stderr (`time` output)
-        stderr_lines = self._stderr.splitlines()
-        self._max_memory = int(stderr_lines[-1])
-        # reconstruct the original stderr (without `time` output)
-        self._stderr = "\n".join(stderr_lines[:-1]) + "\n"
+        # decode and store stdout and stderr
+        # (with the "spill" policy they stay on disk and are read
+        # lazily by the accessors)
+        if self._capture_policy == "spill":
+            self._stdout = None
+            self._stderr = None
+        else:
+            self._stdout = stdout_data.decode("utf-8")
+            self._stderr = stderr_data.decode("utf-8")
+
+        # parse and store the collected performance counters
+        if perf_out_path:
+            try:
+                self._perf_counters = _parse_perf_output(perf_out_path)
+            finally:
+                os.unlink(perf_out_path)
 
         # set as run
         self._run = True
@@ -140,13 +373,21 @@ class ResourceMonitor:
         """Gets the stdout of the process.
 
         Returns:
-            The stdout of the process.
+            The stdout of the process. Empty with the "discard" capture
+            policy; with the "spill" policy the spilled file is read
+            into memory on the first access.
 
         Raises:
             RuntimeError: If the process has not been run.
         """
 
         self._ensure_run()
+
+        # lazily read the spilled output
+        if self._stdout is None and self._stdout_path:
+            with open(self._stdout_path) as f:
+                self._stdout = f.read()
+
         return self._stdout
 
 
@@ -154,16 +395,54 @@ class ResourceMonitor:
         """Gets the stderr of the process.
 
         Returns:
-            The stderr of the process.
+            The stderr of the process. Empty with the "discard" capture
+            policy; with the "spill" policy the spilled file is read
+            into memory on the first access.
 
         Raises:
             RuntimeError: If the process has not been run.
         """
 
         self._ensure_run()
+
+        # lazily read the spilled output
+        if self._stderr is None and self._stderr_path:
+            with open(self._stderr_path) as f:
+                self._stderr = f.read()
+
         return self._stderr
 
 
+    def stdout_path(self) -> Optional[str]:
+        """Gets the path of the spilled stdout file.
+
+        Returns:
+            The path of the stdout file, or None unless the "spill"
+            capture policy was used. The caller owns the file.
+
+        Raises:
+            RuntimeError: If the process has not been run.
+        """
+
+        self._ensure_run()
+        return self._stdout_path
+
+
+    def stderr_path(self) -> Optional[str]:
+        """Gets the path of the spilled stderr file.
+
+        Returns:
+            The path of the stderr file, or None unless the "spill"
+            capture policy was used. The caller owns the file.
+
+        Raises:
+            RuntimeError: If the process has not been run.
+        """
+
+        self._ensure_run()
+        return self._stderr_path
+
+
     def wall_time(self) -> float:
         """Gets the wall clock time of the process.
 
@@ -220,6 +499,114 @@ class ResourceMonitor:
         return self._max_memory
 
 
+    def timeline(self) -> List[Tuple[float, int, float]]:
+        """Gets the resource usage timeline of the process.
+
+        Returns:
+            A list of (elapsed_time, rss, cpu_time) tuples, one per
+            sample: the time since the process start in seconds, the
+            resident set size in KB and the cumulative CPU time
+            (user plus system) in seconds. Empty if the monitor was
+            created without a `sample_interval`.
+
+        Raises:
+            RuntimeError: If the process has not been run.
+        """
+
+        self._ensure_run()
+        return self._timeline
+
+
+    def perf_counters(self) -> Dict[str, float]:
+        """Gets the hardware performance counters of the process.
+
+        Returns:
+            A dictionary mapping each requested perf event name to its
+            count. Empty if no perf events were requested; events the
+            hardware could not count are missing from the dictionary.
+
+        Raises:
+            RuntimeError: If the process has not been run.
+        """
+
+        self._ensure_run()
+        return self._perf_counters
+
+
+    def iteration_time(self) -> Optional[float]:
+        """Gets the per-iteration time reported by the timing harness.
+
+        Binaries built with the injected in-process timing harness (see
+        `obf_perf_core`) report the average wall clock time of one
+        workload iteration on stderr, on a line of the form
+        "OBF_PERF_ITER_NS=<nanoseconds>".
+
+        Returns:
+            The average time of one workload iteration in nanoseconds,
+            or None if the process did not report one (e.g. it was not
+            built with the harness, or its output was not captured).
+
+        Raises:
+            RuntimeError: If the process has not been run.
+        """
+
+        self._ensure_run()
+
+        # scan stderr for the marker line; the last one wins, in case
+        # the workload itself writes lookalike lines before the harness
+        iteration_time = None
+        for line in self.stderr().splitlines():
+            if line.startswith(ITERATION_TIME_MARKER):
+                try:
+                    iteration_time = \
+                        float(line[len(ITERATION_TIME_MARKER):])
+                except ValueError:
+                    # malformed line, ignore it
+                    pass
+
+        return iteration_time
+
+
+    def energy(self) -> Optional[float]:
+        """Gets the energy consumed during the run, in joules.
+
+        The value is the delta of the RAPL package (and DRAM) energy
+        counters across the process lifetime. The counters are
+        socket-wide, not per-process, so the run should have the
+        machine to itself for the number to be attributable.
+
+        Returns:
+            The consumed energy in joules, or None if energy
+            measurement was not requested or the RAPL counters are not
+            readable (see `rapl_available()`).
+
+        Raises:
+            RuntimeError: If the process has not been run.
+        """
+
+        self._ensure_run()
+        return self._energy
+
+
+    def avg_power(self) -> Optional[float]:
+        """Gets the average power drawn during the run, in watts.
+
+        Returns:
+            The consumed energy divided by the wall clock time, or None
+            if energy measurement was not requested or available.
+
+        Raises:
+            RuntimeError: If the process has not been run.
+        """
+
+        self._ensure_run()
+
+        if self._energy is None or self._wall_time <= 0:
+            return None
+
+        return self._energy / self._wall_time
+
+
     def minor_page_faults(self) -> int:
         """Gets the number of minor page faults of the process.
 
@@ -330,3 +717,198 @@ class ResourceMonitor:
         if not self._run:
             raise RuntimeError("Error: cannot get usage information"
                                " before `run()` is called")
+
+
+def rapl_available() -> bool:
+    """Returns whether the RAPL energy counters are readable.
+
+    The counters live in the powercap sysfs tree and are readable only
+    by root on most machines (and absent on machines without RAPL, e.g.
+    most VMs and non-Intel/AMD hardware).
+
+    Returns:
+        True if at least one RAPL domain can be read.
+    """
+
+    return bool(_read_rapl_energy())
+
+
+def _read_rapl_energy() -> Dict[str, Tuple[int, int]]:
+    """Reads the current RAPL energy counters.
+
+    The package-level domains ("intel-rapl:N") and their "dram"
+    subdomains are read; the other subdomains (core, uncore) are
+    skipped, since the package counter already includes them.
+
+    Returns:
+        A dictionary mapping each readable domain directory to a
+        (energy_uj, max_energy_range_uj) pair. Empty if no domain is
+        readable.
+    """
+
+    domains: Dict[str, Tuple[int, int]] = {}
+
+    # package-level domains plus their dram subdomains
+    domain_dirs = glob.glob(os.path.join(RAPL_DIR, "intel-rapl:[0-9]*"))
+    for domain_dir in sorted(domain_dirs):
+        subdomain = domain_dir.rsplit("intel-rapl:", maxsplit=1)[-1]
+        if ":" in subdomain:
+            # subdomain: only dram adds energy not counted in the package
+            try:
+                with open(os.path.join(domain_dir, "name")) as f:
+                    if f.read().strip() != "dram":
+                        continue
+            except OSError:
+                continue
+
+        try:
+            with open(os.path.join(domain_dir, "energy_uj")) as f:
+                energy_uj = int(f.read().strip())
+            with open(os.path.join(domain_dir,
+                                   "max_energy_range_uj")) as f:
+                max_range_uj = int(f.read().strip())
+        except (OSError, ValueError):
+            # not readable (not root) or malformed: skip the domain
+            continue
+
+        domains[domain_dir] = (energy_uj, max_range_uj)
+
+    return domains
+
+
+def _sample_process(pid: int,
+                    peak_holder: List[int],
+                    stop_event: "threading.Event",
+                    follow_child: bool = False,
+                    sample_interval: Optional[float] = None,
+                    timeline: Optional[List[Tuple[float,
+                                                  int,
+                                                  float]]] = None) -> None:
+    """Samples the resource usage of the given process from /proc.
+
+    Periodically reads `/proc/<pid>/status` until `stop_event` is set,
+    keeping the highest observed VmHWM value (in KB) in `peak_holder[0]`.
+    Since VmHWM is itself a kernel-maintained high-water mark, the only
+    inaccuracy is memory allocated between the last sample and the
+    process exit.
+
+    When `sample_interval` is given, the resource usage timeline is also
+    recorded: every `sample_interval` seconds a
+    (elapsed_time, rss, cpu_time) tuple is appended to `timeline`, with
+    the RSS (in KB) read from `/proc/<pid>/smaps_rollup` and the
+    cumulative CPU time (in seconds) from `/proc/<pid>/stat`.
+
+    Args:
+        pid: Process id of the process to sample.
+        peak_holder: Single-element list the peak value is written to.
+        stop_event: Event signalling the process has terminated.
+        follow_child: Whether to sample the first child of `pid` instead
+            of `pid` itself (used when `pid` is a wrapper like perf).
+        sample_interval: Interval between timeline samples, in seconds.
+            Optional, defaults to no timeline sampling.
+        timeline: List the timeline samples are appended to. Required
+            when `sample_interval` is given.
+    """
+
+    # when the command is wrapped, the interesting process is the
+    # wrapper's child, resolved lazily since it may not exist yet
+    target_pid = None if follow_child else pid
+
+    # clock ticks per second, to convert /proc/<pid>/stat CPU times
+    ticks_per_second = os.sysconf("SC_CLK_TCK")
+
+    start = time.perf_counter()
+    # time of the last timeline sample, relative to `start`
+    last_timeline_sample = None
+
+    while True:
+        if target_pid is None:
+            try:
+                with open(f"/proc/{pid}/task/{pid}/children") as f:
+                    children = f.read().split()
+                if children:
+                    target_pid = int(children[0])
+            except (OSError, ValueError):
+                pass
+
+        if target_pid is not None:
+            try:
+                with open(f"/proc/{target_pid}/status") as f:
+                    for line in f:
+                        if line.startswith("VmHWM:"):
+                            # line format: "VmHWM:   <value> kB"
+                            hwm = int(line.split()[1])
+                            peak_holder[0] = max(peak_holder[0], hwm)
+                            break
+            except (OSError, ValueError, IndexError):
+                # the process exited (or is exiting): keep the last sample
+                pass
+
+        # record a timeline sample once per sampling interval
+        elapsed = time.perf_counter() - start
+        if sample_interval is not None and timeline is not None \
+           and target_pid is not None \
+           and (last_timeline_sample is None
+                or elapsed - last_timeline_sample >= sample_interval):
+            try:
+                # current RSS (in KB) from smaps_rollup
+                rss = 0
+                with open(f"/proc/{target_pid}/smaps_rollup") as f:
+                    for line in f:
+                        if line.startswith("Rss:"):
+                            # line format: "Rss:   <value> kB"
+                            rss = int(line.split()[1])
+                            break
+                # cumulative CPU time (user + system) from stat
+                # (fields 14 and 15, in clock ticks; the process name
+                # in field 2 may contain spaces, but it is wrapped in
+                # parentheses, so the split is anchored after it)
+                with open(f"/proc/{target_pid}/stat") as f:
+                    stat_fields = f.read().rsplit(")", maxsplit=1)[1].split()
+                cpu_time = (int(stat_fields[11]) + int(stat_fields[12])) \
+                           / ticks_per_second
+
+                timeline.append((elapsed, rss, cpu_time))
+                last_timeline_sample = elapsed
+            except (OSError, ValueError, IndexError):
+                # the process exited (or is exiting): stop sampling
+                pass
+
+        # wait for the next sampling period, or stop if the process
+        # has been reaped in the meanwhile
+        if stop_event.wait(MEMORY_SAMPLE_INTERVAL):
+            return
+
+
+def _parse_perf_output(path: str) -> Dict[str, float]:
+    """Parses the output file written by `perf stat -x ,`.
+
+    Args:
+        path: Path of the perf output file.
+
+    Returns:
+        A dictionary mapping each event name to its count. Events the
+        hardware could not count ("<not counted>", "<not supported>")
+        are skipped.
+    """
+
+    counters: Dict[str, float] = {}
+
+    try:
+        with open(path) as f:
+            for line in f:
+                # csv line format: <value>,<unit>,<event>,<runtime>,...
+                # (comment lines start with '#')
+                parts = line.strip().split(",")
+                if line.startswith("#") or len(parts) < 3:
+                    continue
+                try:
+                    counters[parts[2]] = float(parts[0])
+                except ValueError:
+                    # uncountable event: skip it
+                    continue
+    except OSError:
+        # missing output file (e.g. perf failed): no counters
+        pass
+
+    return counters
@@ -1,7 +1,10 @@
 """Module that defines the Result and ResultContainer classes.
 
 The Result class represents the result of a single run of the benchmark.
-The ResultContainer class is a container for the results of the benchmark.
+The ResultContainer class is a container for the results of the benchmark:
+it keeps streaming summary accumulators (mean, standard deviation and the
+`PERCENTILES`) per metric, updated as the samples are added, and
+optionally retains the raw samples for the distribution plots.
 
 Typical usage example:
     import result_container as rc
@@ -25,13 +28,22 @@ Typical usage example:
     # get the average and standard deviation of the results of all metrics
     # for each obfuscation technique
     metric_avg_by_obf, metric_std_by_obf = container.get_average_results()
+
+    # get the 95th percentile of a metric for each obfuscation technique
+    metric_p95_by_obf = container.percentile_results("metric_name", 0.95)
 """
 
 
 import json
-import statistics
+import math
 from dataclasses import dataclass, asdict
-from typing import List, Dict, Tuple, Union
+from typing import Iterator, List, Dict, Optional, Tuple, Union
+
+
+# percentiles tracked by the streaming accumulators; the tail
+# percentiles expose latency the mean hides (e.g. the JIT configs'
+# slow first iterations)
+PERCENTILES = [ 0.5, 0.95, 0.99 ]
 
 
 @dataclass(frozen=True)
@@ -107,6 +119,54 @@ class Result:
     execution_total_context_switches: int
     """Number of total context switches during the execution process."""
 
+    # hardware performance counters, only collected when the analysis
+    # runs with perf events enabled
+
+    execution_cycles: Optional[float] = None
+    """Number of CPU cycles during the execution process."""
+
+    execution_instructions: Optional[float] = None
+    """Number of retired instructions during the execution process."""
+
+    execution_ipc: Optional[float] = None
+    """Instructions per cycle during the execution process."""
+
+    execution_cache_references: Optional[float] = None
+    """Number of cache references during the execution process."""
+
+    execution_cache_misses: Optional[float] = None
+    """Number of cache misses during the execution process."""
+
+    execution_cache_miss_rate: Optional[float] = None
+    """Cache miss rate (percent) during the execution process."""
+
+    execution_branch_instructions: Optional[float] = None
+    """Number of branch instructions during the execution process."""
+
+    execution_branch_misses: Optional[float] = None
+    """Number of branch mispredictions during the execution process."""
+
+    execution_branch_miss_rate: Optional[float] = None
+    """Branch misprediction rate (percent) during the execution process."""
+
+    execution_iteration_time: Optional[float] = None
+    """Average wall clock time of one in-process workload iteration, in
+    nanoseconds. Only collected when the analysis runs with the injected
+    timing harness."""
+
+    execution_energy: Optional[float] = None
+    """Energy consumed during the execution process, in joules. Only
+    collected when the analysis runs with energy measurement enabled."""
+
+    execution_avg_power: Optional[float] = None
+    """Average power drawn during the execution process, in watts. Only
+    collected when the analysis runs with energy measurement enabled."""
+
+    execution_warmup_runs: Optional[int] = None
+    """Number of warmup runs performed before the timing sequence
+    reached steady state. Only collected when the analysis runs with
+    adaptive warmup."""
+
 
     def __getitem__(self, name: str):
         """Accesses the fields of the Result using the [] operator.
@@ -132,11 +192,196 @@ class Result:
         return list(Result.__dataclass_fields__.keys())
 
 
+class _P2Quantile:
+    """Streaming quantile estimate with the P-square algorithm.
+
+    Tracks a single quantile with five markers (no stored samples), so
+    the memory cost is constant regardless of the number of
+    observations. The estimate converges to the true quantile as the
+    sample count grows; for fewer than five observations the exact
+    value is returned.
+
+    Reference: Jain, Chlamtac, "The P^2 Algorithm for Dynamic
+    Calculation of Quantiles and Histograms Without Storing
+    Observations", CACM 1985.
+    """
+
+    def __init__(self, p: float):
+        """Initializes the estimator for the given quantile.
+
+        Args:
+            p: The quantile to track, in (0, 1) (e.g. 0.95).
+        """
+
+        self._p = p
+        # marker heights (the first five observations, then estimates)
+        self._heights: List[float] = []
+        # actual marker positions (1-based observation counts)
+        self._positions = [ 1, 2, 3, 4, 5 ]
+        # desired marker positions, and their per-observation increments
+        self._desired = [ 1.0, 1 + 2*p, 1 + 4*p, 3 + 2*p, 5.0 ]
+        self._increments = [ 0.0, p/2, p, (1 + p)/2, 1.0 ]
+
+    def add(self, value: float) -> None:
+        """Feeds one observation to the estimator."""
+
+        if len(self._heights) < 5:
+            # initialization phase: store the first five observations
+            self._heights.append(value)
+            self._heights.sort()
+            return
+
+        heights, positions = self._heights, self._positions
+
+        # find the cell the observation falls in, adjusting the
+        # extreme markers when it falls outside the current range
+        if value < heights[0]:
+            heights[0] = value
+            cell = 0
+        elif value >= heights[4]:
+            heights[4] = value
+            cell = 3
+        else:
+            cell = 0
+            while value >= heights[cell + 1]:
+                cell += 1
+
+        # shift the positions of the markers above the cell
+        for i in range(cell + 1, 5):
+            positions[i] += 1
+        for i in range(5):
+            self._desired[i] += self._increments[i]
+
+        # move the middle markers towards their desired positions
+        for i in range(1, 4):
+            delta = self._desired[i] - positions[i]
+            if (delta >= 1 and positions[i+1] - positions[i] > 1) or \
+               (delta <= -1 and positions[i-1] - positions[i] < -1):
+                step = 1 if delta > 0 else -1
+
+                # piecewise-parabolic prediction of the marker height
+                new_height = heights[i] + step / (positions[i+1]
+                                                  - positions[i-1]) * (
+                    (positions[i] - positions[i-1] + step)
+                        * (heights[i+1] - heights[i])
+                        / (positions[i+1] - positions[i])
+                    + (positions[i+1] - positions[i] - step)
+                        * (heights[i] - heights[i-1])
+                        / (positions[i] - positions[i-1]))
+
+                # fall back to linear prediction when the parabola
+                # would break the marker ordering
+                if not heights[i-1] < new_height < heights[i+1]:
+                    new_height = heights[i] \
+                        + step * (heights[i + step] - heights[i]) \
+                               / (positions[i + step] - positions[i])
+
+                heights[i] = new_height
+                positions[i] += step
+
+    def value(self) -> float:
+        """Returns the current quantile estimate.
+
+        Raises:
+            ValueError: If no observation was fed yet.
+        """
+
+        if not self._heights:
+            raise ValueError("no observations")
+
+        if len(self._heights) < 5:
+            # initialization phase: exact quantile of the stored
+            # observations (nearest rank)
+            rank = max(0, math.ceil(self._p * len(self._heights)) - 1)
+            return self._heights[rank]
+
+        # the middle marker tracks the quantile
+        return self._heights[2]
+
+
+class _StreamingStats:
+    """Streaming summary statistics of one metric of one technique.
+
+    Accumulates the count, mean and variance with Welford's online
+    algorithm and the `PERCENTILES` with P-square estimators, so the
+    summary queries are O(1) and the memory cost is constant no matter
+    how many samples are added.
+    """
+
+    def __init__(self):
+        """Initializes the accumulators."""
+
+        self._count = 0
+        self._mean = 0.0
+        # sum of squared distances from the running mean (Welford M2)
+        self._m2 = 0.0
+        self._quantiles = { p: _P2Quantile(p) for p in PERCENTILES }
+
+    def add(self, value: Union[int, float, None]) -> None:
+        """Feeds one sample to the accumulators.
+
+        Args:
+            value: The sample. None samples (optional metrics that were
+                not collected) are ignored.
+        """
+
+        if value is None:
+            return
+
+        # Welford's online mean/variance update
+        self._count += 1
+        delta = value - self._mean
+        self._mean += delta / self._count
+        self._m2 += delta * (value - self._mean)
+
+        for quantile in self._quantiles.values():
+            quantile.add(value)
+
+    def count(self) -> int:
+        """Returns the number of (non-None) samples fed so far."""
+
+        return self._count
+
+    def mean(self) -> float:
+        """Returns the mean of the samples."""
+
+        return self._mean
+
+    def stdev(self) -> float:
+        """Returns the sample standard deviation of the samples.
+
+        Zero when fewer than two samples were fed, matching the
+        behavior of the stored-samples summary.
+        """
+
+        if self._count < 2:
+            return 0.0
+        return math.sqrt(self._m2 / (self._count - 1))
+
+    def percentile(self, p: float) -> float:
+        """Returns the estimate of one of the tracked `PERCENTILES`.
+
+        Args:
+            p: The percentile, one of `PERCENTILES`.
+        """
+
+        return self._quantiles[p].value()
+
+
 class ResultContainer:
     """Container for the results of the benchmark."""
 
-    def __init__(self):
-        """Initializes the ResultContainer."""
+    def __init__(self, keep_samples: bool = True):
+        """Initializes the ResultContainer.
+
+        Args:
+            keep_samples: Whether to retain the raw samples, on top of
+                the streaming summary accumulators. The raw samples are
+                only needed by the distribution plots (violin plots)
+                and the raw JSON dump; without them the memory cost of
+                the container is constant per metric, which matters at
+                matrix scale (programs x configs x runs).
+        """
 
         # dictionary that maps each obfuscation technique to a dictionary
         # containing the list of values of each metric
@@ -152,8 +397,30 @@ class ResultContainer:
         #         "metric2": [10, 11, 12]
         #     }
         # }
+        # only filled when `keep_samples` is enabled
+        self._keep_samples = keep_samples
         self._results: Dict[str, Dict[str, List[Union[int, float]]]] = dict()
 
+        # streaming summary accumulators (count, mean, variance and
+        # percentiles) of each metric of each obfuscation technique,
+        # updated as the samples are added, so the summary queries do
+        # not re-reduce the sample lists
+        # dict<name,dict<metric,_StreamingStats>>
+        self._stats: Dict[str, Dict[str, _StreamingStats]] = dict()
+
+        # dictionary that maps each obfuscation technique to the list of
+        # resource usage timelines of its measured runs (one timeline
+        # per run, each a list of (elapsed_time, rss, cpu_time) tuples);
+        # only filled when the analysis runs with timeline sampling
+        self._timelines: Dict[str,
+                              List[List[Tuple[float, int, float]]]] = dict()
+
+        # free-form description of the measurement environment (e.g.
+        # the isolation settings the runs were measured under), attached
+        # to the container so results from different campaigns can be
+        # checked for comparability; serialized in the JSON output
+        self._metadata: Dict = dict()
+
 
     def obfuscation_types(self) -> List[str]:
         """Returns the names of the obfuscation techniques.
@@ -162,7 +429,7 @@ class ResultContainer:
             The list of names of the obfuscation techniques.
         """
 
-        return list(self._results.keys())
+        return list(self._stats.keys())
 
 
     def add_result(self, result: Result) -> None:
@@ -172,22 +439,150 @@ class ResultContainer:
             result: The Result to be added.
         """
 
-        # if the obfuscation technique has not been added yet,
-        # create an empty dict for it
-        if result.name not in self._results:
-            # dict<metric,list<value>>
-            self._results[result.name] = dict()
-
         # extract from the Result the list of all its key-value pairs
         # except the first one ("name")
         result_items = list(asdict(result).items())[1:]
-        # for each metric-value pair, add the value to the list of values
+        # for each metric-value pair, add the value to the accumulators
+        # (and to the list of values, when the samples are retained)
         for metric_name, value in result_items:
-            # if no list of values for the metric exists, create it (empty)
-            if metric_name not in self._results[result.name]:
-                self._results[result.name][metric_name] = []
-            # add the value to the list of values for the metric
-            self._results[result.name][metric_name].append(value)
+            self.__add_sample(result.name, metric_name, value)
+
+
+    def add_metric_samples(self,
+                           name: str,
+                           metric_name: str,
+                           values: List[Union[int, float]]) -> None:
+        """Adds a list of samples of a single metric to the container.
+
+        Unlike `add_result`, this allows different metrics to have a
+        different number of samples for the same obfuscation technique,
+        which is needed when the pipeline phases are run a different
+        number of times.
+
+        Args:
+            name: Name of the obfuscation technique.
+            metric_name: Name of the metric.
+            values: List of values to add for the metric.
+        """
+
+        # check if the metric exists
+        if metric_name not in Result.fields():
+            raise RuntimeError(f"Metric '{metric_name}' does not exist")
+
+        for value in values:
+            self.__add_sample(name, metric_name, value)
+
+
+    def __add_sample(self,
+                     name: str,
+                     metric_name: str,
+                     value: Union[int, float, None]) -> None:
+        """Feeds one sample to the accumulators (and to the raw sample
+        lists, when the samples are retained).
+
+        Args:
+            name: Name of the obfuscation technique.
+            metric_name: Name of the metric.
+            value: The sample value.
+        """
+
+        # if the obfuscation technique has not been added yet,
+        # create its accumulator dict
+        if name not in self._stats:
+            # dict<metric,_StreamingStats>
+            self._stats[name] = dict()
+        if metric_name not in self._stats[name]:
+            self._stats[name][metric_name] = _StreamingStats()
+
+        # update the streaming summary (None samples are ignored there)
+        self._stats[name][metric_name].add(value)
+
+        if self._keep_samples:
+            # keep the raw sample, for the distribution plots and the
+            # raw JSON dump
+            if name not in self._results:
+                # dict<metric,list<value>>
+                self._results[name] = dict()
+            if metric_name not in self._results[name]:
+                self._results[name][metric_name] = []
+            self._results[name][metric_name].append(value)
+
+
+    def add_timeline(self,
+                     name: str,
+                     timeline: List[Tuple[float, int, float]]) -> None:
+        """Adds the resource usage timeline of a single run.
+
+        Args:
+            name: Name of the obfuscation technique.
+            timeline: List of (elapsed_time, rss, cpu_time) samples.
+        """
+
+        # if the obfuscation technique has not been added yet,
+        # create an empty list for it
+        if name not in self._timelines:
+            self._timelines[name] = []
+
+        self._timelines[name].append(timeline)
+
+
+    def timelines(self) -> Dict[str, List[List[Tuple[float, int, float]]]]:
+        """Returns the resource usage timelines of the measured runs.
+
+        Returns:
+            A dictionary mapping each obfuscation technique to the list
+            of timelines of its runs.
+        """
+
+        return self._timelines
+
+
+    def has_timelines(self) -> bool:
+        """Returns whether any resource usage timelines were collected."""
+
+        return any(self._timelines.values())
+
+
+    def set_metadata(self, metadata: Dict) -> None:
+        """Attaches measurement environment metadata to the container.
+
+        Args:
+            metadata: JSON-serializable description of the measurement
+                environment (e.g. the isolation settings). Merged into
+                the already attached metadata.
+        """
+
+        self._metadata.update(metadata)
+
+
+    def metadata(self) -> Dict:
+        """Returns the attached measurement environment metadata.
+
+        Returns:
+            The metadata dictionary. Empty if none was attached.
+        """
+
+        return self._metadata
+
+
+    def has_metric(self, metric_name: str) -> bool:
+        """Returns whether any samples were collected for the given metric.
+
+        Useful for the optional metrics (e.g. the hardware performance
+        counters), which are only present when the analysis was run with
+        the corresponding feature enabled.
+
+        Args:
+            metric_name: Name of the metric.
+
+        Returns:
+            True if at least one obfuscation technique has samples for
+            the metric.
+        """
+
+        return any(metric_name in stats_dict
+                   and stats_dict[metric_name].count() > 0
+                   for stats_dict in self._stats.values())
 
 
     def metric_results(self,
@@ -199,23 +594,68 @@ class ResultContainer:
 
         Returns:
             A dictionary mapping each obfuscation technique to the list of
-            values of the given metric.
+            values of the given metric. Techniques without samples of
+            the metric (e.g. a baseline reused from a campaign measured
+            without the metric's flag) are left out, like
+            `percentile_results` does.
+
+        Raises:
+            RuntimeError: If the metric does not exist, or the raw
+                samples were not retained (see `keep_samples`).
         """
 
         # check if the metric exists
         if metric_name not in Result.fields():
             raise RuntimeError(f"Metric '{metric_name}' does not exist")
 
+        # the raw samples only exist when their retention is enabled
+        if not self._keep_samples:
+            raise RuntimeError("the raw samples were not retained"
+                               " (the container was created with"
+                               " keep_samples=False)")
+
         # dictionary that maps each obfuscation technique to the list of
         # values of the given metric
         # dict<obf_name,list<value>>
         metric_results_by_obf: Dict[str, List[Union[int, float]]] = \
             { obf_name: self._results[obf_name][metric_name]
-              for obf_name in self._results }
+              for obf_name in self._results
+              if metric_name in self._results[obf_name] }
 
         return metric_results_by_obf
 
 
+    def percentile_results(self,
+                           metric_name: str,
+                           p: float) -> Dict[str, float]:
+        """Returns a percentile of a metric for each obfuscation technique.
+
+        The percentile comes from the streaming estimators, so the
+        query is O(1) and works whether or not the raw samples were
+        retained.
+
+        Args:
+            metric_name: Name of the metric.
+            p: The percentile, one of `PERCENTILES` (e.g. 0.95).
+
+        Returns:
+            A dictionary mapping each obfuscation technique to the
+            percentile estimate of the given metric.
+
+        Raises:
+            RuntimeError: If the metric does not exist.
+        """
+
+        # check if the metric exists
+        if metric_name not in Result.fields():
+            raise RuntimeError(f"Metric '{metric_name}' does not exist")
+
+        return { obf_name: stats_dict[metric_name].percentile(p)
+                 for obf_name, stats_dict in self._stats.items()
+                 if metric_name in stats_dict
+                 and stats_dict[metric_name].count() > 0 }
+
+
     def get_average_results(self) -> Tuple[Dict[str,
                                                 Dict[str, Union[float, str]]],
                                            Dict[str,
@@ -233,8 +673,10 @@ class ResultContainer:
         avg_results: Dict[str, Dict[str, Union[float, str]]] = dict()
         std_results: Dict[str, Dict[str, Union[float, str]]] = dict()
 
-        # for each obfuscation technique, compute the average and the stdev
-        for obf_name, curr_results_dict in self._results.items():
+        # the summaries come straight from the streaming accumulators,
+        # so the query is O(1) per metric instead of re-reducing every
+        # stored sample list on every call
+        for obf_name, curr_stats_dict in self._stats.items():
             # dictionaries that map each metric to the average (and standard
             # deviation) of its values for the current obfuscation technique
             avg_result_params: Dict[str, Union[float, str]] = \
@@ -242,23 +684,9 @@ class ResultContainer:
             std_result_params: Dict[str, Union[float, str]] = \
                     dict(name=obf_name)
 
-            # for each metric, compute the average and the standard deviation
-            for metric_name, metric_result_list in curr_results_dict.items():
-                if len(metric_result_list) > 1:
-                    # more than one value
-
-                    # compute the average and the standard deviation
-                    avg_result_params[metric_name] = \
-                            statistics.mean(metric_result_list)
-                    std_result_params[metric_name] = \
-                            statistics.stdev(metric_result_list)
-                else:
-                    # only one value
-
-                    # the average is the value itself
-                    avg_result_params[metric_name] = metric_result_list[0]
-                    # the standard deviation is 0.0
-                    std_result_params[metric_name] = 0.0
+            for metric_name, stats in curr_stats_dict.items():
+                avg_result_params[metric_name] = stats.mean()
+                std_result_params[metric_name] = stats.stdev()
 
             # build the Result objects for the current obfuscation technique
             avg_results[obf_name] = avg_result_params
@@ -267,7 +695,68 @@ class ResultContainer:
         return avg_results, std_results
 
 
+    def export_rows(self) -> Iterator[Tuple[str, str, int,
+                                            Union[int, float, None]]]:
+        """Yields the raw samples as tidy long-format rows.
+
+        One row per retained sample, `(name, metric, run, value)`,
+        where `run` is the 0-based index of the sample within its
+        metric. The rows are generated lazily, so the columnar exports
+        can stream them without first materializing the whole nested
+        results document.
+
+        Yields:
+            (name, metric, run, value) tuples, in insertion order.
+
+        Raises:
+            RuntimeError: If the raw samples were not retained (see
+                `keep_samples`).
+        """
+
+        if not self._keep_samples:
+            raise RuntimeError("the raw samples were not retained"
+                               " (the container was created with"
+                               " keep_samples=False)")
+
+        for name, metrics in self._results.items():
+            for metric_name, values in metrics.items():
+                for run, value in enumerate(values):
+                    yield name, metric_name, run, value
+
+
     def to_json(self) -> str:
-        """Serializes the ResultContainer to JSON."""
+        """Serializes the ResultContainer to JSON.
+
+        When measurement environment metadata is attached, the document
+        has a "metadata" and a "results" section; otherwise it is the
+        plain results dictionary, for backward compatibility.
+        When the raw samples were not retained, each metric is
+        serialized as its streaming summary (count, mean, stdev and
+        percentiles) instead of its sample list.
+        """
 
-        return json.dumps(self._results, indent=4)
+        if self._keep_samples:
+            results: Dict = self._results
+        else:
+            # no raw samples: serialize the streaming summaries
+            results = {
+                obf_name: {
+                    metric_name: {
+                        "count": stats.count(),
+                        "mean": stats.mean(),
+                        "stdev": stats.stdev(),
+                        **{ f"p{round(p * 100)}": stats.percentile(p)
+                            for p in PERCENTILES }
+                    }
+                    for metric_name, stats in stats_dict.items()
+                    if stats.count() > 0
+                }
+                for obf_name, stats_dict in self._stats.items()
+            }
+
+        if self._metadata:
+            return json.dumps({ "metadata": self._metadata,
+                                "results": results },
+                              indent=4)
+
+        return json.dumps(results, indent=4)
@@ -0,0 +1,215 @@
+"""Durable streaming store for the analysis results.
+
+This module provides the ResultsStore class, an append-only JSONL store
+the analysis writes each completed (program, config) unit to as soon as
+its measured runs finish. A crash or interrupt mid-campaign then loses
+at most the units still in progress, instead of everything: restarting
+with resume enabled skips the units already in the store and merges
+their stored samples into the final results.
+
+One JSON object per line, each describing one completed unit:
+
+    {"unit": "<name>", "samples": {...}, "timelines": [...]}
+
+plus an optional environment record describing the machine the samples
+were measured on (see `opcore.environment_fingerprint`), so stores
+from different machines are not silently merged:
+
+    {"environment": {"cpu_model": ..., "gcc": ..., ...}}
+
+The file is opened in append mode and flushed (and fsync'ed) after
+every record, so completed units survive a hard kill. When the same
+unit appears more than once (e.g. the campaign was re-run on the same
+file without resume), the last record wins.
+
+Typical usage example:
+    import obf_perf.results_store as rs
+
+    store = rs.ResultsStore("campaign.jsonl")
+
+    # units completed in a previous (interrupted) campaign
+    done = store.completed_units()
+
+    # record a freshly completed unit
+    store.record_unit("02-flatten", samples, timelines)
+
+    # merge the stored units into a ResultContainer
+    store.load_unit(container, "02-flatten")
+"""
+
+
+import json
+import os
+from typing import Dict, List, Optional, Union
+
+import obf_perf.result_container as rc
+
+
+class ResultsStore:
+    """Append-only JSONL store of completed analysis units."""
+
+    def __init__(self, path: str):
+        """Initializes the ResultsStore.
+
+        The store file is read (when it exists) to recover the units
+        completed by previous campaigns; it is created lazily on the
+        first recorded unit otherwise.
+
+        Args:
+            path: Path of the JSONL store file.
+
+        Raises:
+            OSError: If an existing store file cannot be read.
+            ValueError: If an existing store file is malformed.
+        """
+
+        self._path = path
+
+        # records of the already completed units, by unit name
+        # (the last record of a unit wins, see the module docstring)
+        self._records: Dict[str, Dict] = dict()
+
+        # environment fingerprint of the machine the stored samples
+        # were measured on, when recorded
+        self._environment: Optional[Dict[str, str]] = None
+
+        if os.path.isfile(path):
+            with open(path) as f:
+                for line_number, line in enumerate(f, start=1):
+                    line = line.strip()
+                    if not line:
+                        # ignore blank lines (e.g. a partial last line
+                        # truncated away by a crash mid-write)
+                        continue
+                    try:
+                        record = json.loads(line)
+                        if "unit" in record:
+                            self._records[record["unit"]] = record
+                        else:
+                            self._environment = record["environment"]
+                    except (ValueError, KeyError, TypeError):
+                        raise ValueError(
+                            f"malformed results store record"
+                            f" ('{path}', line {line_number})")
+
+
+    def path(self) -> str:
+        """Returns the path of the store file."""
+
+        return self._path
+
+
+    def completed_units(self) -> List[str]:
+        """Returns the names of the units already in the store.
+
+        Returns:
+            The list of unit names, in first-recorded order.
+        """
+
+        return list(self._records.keys())
+
+
+    def environment(self) -> Optional[Dict[str, str]]:
+        """Returns the recorded environment fingerprint.
+
+        Returns:
+            The fingerprint dictionary (see
+            `opcore.environment_fingerprint`), or None if none was
+            recorded.
+        """
+
+        return self._environment
+
+
+    def record_environment(self, environment: Dict[str, str]) -> None:
+        """Appends the environment fingerprint to the store.
+
+        Args:
+            environment: The fingerprint of the machine the samples
+                are measured on (see
+                `opcore.environment_fingerprint`).
+
+        Raises:
+            OSError: If the store file cannot be written.
+        """
+
+        with open(self._path, 'a') as f:
+            f.write(json.dumps({ "environment": environment }) + "\n")
+            f.flush()
+            os.fsync(f.fileno())
+
+        self._environment = environment
+
+
+    def unit_samples(self,
+                     unit_name: str) -> Dict[str, List[Union[int, float]]]:
+        """Returns the stored samples of a unit.
+
+        Args:
+            unit_name: Name of the unit.
+
+        Returns:
+            The samples of the unit (dict mapping metric name to list
+            of values).
+
+        Raises:
+            KeyError: If the unit is not in the store.
+        """
+
+        return self._records[unit_name]["samples"]
+
+
+    def record_unit(self,
+                    unit_name: str,
+                    samples: Dict[str, List[Union[int, float]]],
+                    timelines: List[List] = []) -> None:
+        """Appends a completed unit to the store.
+
+        The record is flushed and fsync'ed before returning, so the
+        unit survives a hard kill right after.
+
+        Args:
+            unit_name: Name of the unit (e.g. the config name).
+            samples: The measured samples of the unit (dict mapping
+                metric name to list of values).
+            timelines: The resource usage timelines of the unit's
+                measured runs, when timeline sampling was enabled.
+
+        Raises:
+            OSError: If the store file cannot be written.
+        """
+
+        record = { "unit": unit_name,
+                   "samples": dict(samples),
+                   "timelines": list(timelines) }
+
+        with open(self._path, 'a') as f:
+            f.write(json.dumps(record) + "\n")
+            f.flush()
+            os.fsync(f.fileno())
+
+        self._records[unit_name] = record
+
+
+    def load_unit(self,
+                  container: rc.ResultContainer,
+                  unit_name: str) -> None:
+        """Merges the stored samples of a unit into a ResultContainer.
+
+        Args:
+            container: The ResultContainer to merge into.
+            unit_name: Name of the unit to load.
+
+        Raises:
+            KeyError: If the unit is not in the store.
+        """
+
+        record = self._records[unit_name]
+
+        for metric_name, values in record["samples"].items():
+            container.add_metric_samples(unit_name, metric_name, values)
+
+        # JSON has no tuples: restore the (time, rss, cpu_time) samples
+        for timeline in record.get("timelines", []):
+            container.add_timeline(unit_name,
+                                   [ tuple(sample) for sample in timeline ])
@@ -0,0 +1,305 @@
+"""Self-benchmark of the measurement harness itself.
+
+This module quantifies the overhead and bias of obf-perf's own
+measurement path (the `rm.ResourceMonitor` spawn/pipe/wait4 machinery
+and the per-run bookkeeping around it) by running calibrated workloads
+whose true cost is known by construction:
+
+- a null workload (an empty `main`), whose measured wall time is the
+  timing floor of the harness and whose end-to-end cost is the fixed
+  per-run overhead every measured run pays;
+- a self-timing busy loop, which measures its own duration in-process
+  with `clock_gettime` and reports it on stderr, so the difference to
+  the harness-measured wall time is the time the wrapper wrongly bills
+  to the program;
+- a known-RSS allocator, which touches a fixed number of bytes, so the
+  difference to the harness-measured peak memory is the memory
+  measurement bias (the program's own runtime footprint plus any
+  accounting error).
+
+The report can be appended to a JSONL history file together with the
+environment fingerprint, so a change to the monitor or the scheduler
+that regresses measurement quality shows up as a jump in the recorded
+series.
+
+Typical usage example:
+    import obf_perf.self_benchmark as sb
+
+    report = sb.run_self_benchmark(runs=20,
+                                   history_path="self-bench.jsonl")
+    print(report["timing_floor_s"])
+"""
+
+
+import datetime
+import json
+import os
+import statistics
+import tempfile
+import time
+from typing import Callable, Dict, List, Optional
+
+import obf_perf.obf_perf_core as opcore
+import obf_perf.resource_monitor as rm
+
+
+# number of loop iterations of the busy workload; sized to run for
+# tens of milliseconds on current machines, well above the timing
+# floor, so the measured bias is not drowned in scheduling noise
+_BUSY_ITERATIONS = 100_000_000
+
+# bytes touched by the allocator workload (64 MiB), large enough to
+# dominate the program's own runtime footprint
+_ALLOC_BYTES = 64 * 1024 * 1024
+
+# the null workload: the harness cost of running nothing
+_NULL_SOURCE = """\
+int main(void) {
+    return 0;
+}
+"""
+
+# the busy workload: times itself in-process around a loop of known
+# iteration count and reports its own nanoseconds on stderr, providing
+# the ground truth the harness-measured wall time is compared against
+_BUSY_SOURCE = """\
+#include <stdio.h>
+#include <time.h>
+
+int main(void) {
+    struct timespec start, end;
+    volatile unsigned long long acc = 0;
+    unsigned long long i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < %dULL; i++) {
+        acc += i;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    fprintf(stderr, "%%lld\\n",
+            (long long) (end.tv_sec - start.tv_sec) * 1000000000LL
+            + (end.tv_nsec - start.tv_nsec));
+    return 0;
+}
+""" % _BUSY_ITERATIONS
+
+# the allocator workload: touches a known number of bytes, providing
+# the ground truth the harness-measured peak RSS is compared against
+_ALLOC_SOURCE = """\
+#include <stdlib.h>
+#include <string.h>
+
+int main(void) {
+    size_t size = %dUL;
+    char *block = malloc(size);
+
+    if (!block) {
+        return 1;
+    }
+    /* touch every page, so the allocation is resident */
+    memset(block, 1, size);
+    return block[size / 2] - 1;
+}
+""" % _ALLOC_BYTES
+
+
+def run_self_benchmark(runs: int = 20,
+                       history_path: Optional[str] = None,
+                       step_callback: Optional[Callable] = None) -> Dict:
+    """Runs the self-benchmark and returns the report.
+
+    The three calibrated workloads are compiled and then run `runs`
+    times each through the same `rm.ResourceMonitor` path the real
+    measured runs take.
+
+    Args:
+        runs: Number of monitored runs per workload.
+        history_path: Path of a JSONL history file the report is
+            appended to, so measurement-quality regressions can be
+            detected across harness changes. Optional, defaults to not
+            recording the report.
+        step_callback: Callback function called after every monitored
+            run (there are `self_benchmark_steps(runs)` in total).
+            Optional.
+
+    Returns:
+        The report dictionary, with the entries:
+        - "timestamp": ISO date and time of the benchmark;
+        - "environment": the environment fingerprint (see
+          `opcore.environment_fingerprint`);
+        - "runs": the number of monitored runs per workload;
+        - "timing_floor_s": smallest wall time the harness measured
+          for the null workload;
+        - "per_run_cost_s": mean end-to-end cost of one monitored null
+          run (spawn, pipes, wait4 and bookkeeping), i.e. the fixed
+          cost every measured run adds to a campaign;
+        - "timing_bias_s": mean harness-measured wall time minus
+          in-process time of the busy workload, i.e. the time the
+          wrapper bills to the program; with "timing_bias_stdev_s";
+        - "rss_bias_kb": mean harness-measured peak RSS minus the
+          bytes the allocator workload actually touched, in KB.
+
+    Raises:
+        OSError: If a workload cannot be written or compiled.
+        CalledProcessError: If a compilation or a workload run fails.
+    """
+
+    if runs < 2:
+        raise ValueError("`runs` must be >= 2")
+
+    with tempfile.TemporaryDirectory() as tmp_dir_name:
+        # build the three workloads (one gcc run each; -O0 so the busy
+        # loop is not optimized away around the `volatile` accumulator)
+        null_exe = _compile_workload("null", _NULL_SOURCE, tmp_dir_name)
+        busy_exe = _compile_workload("busy", _BUSY_SOURCE, tmp_dir_name)
+        alloc_exe = _compile_workload("alloc", _ALLOC_SOURCE, tmp_dir_name)
+
+        # null workload: timing floor and fixed per-run cost
+        null_wall_times: List[float] = []
+        null_elapsed_times: List[float] = []
+        for _ in range(runs):
+            run_start = time.monotonic()
+            monitor = rm.ResourceMonitor([null_exe],
+                                         capture_policy="discard")
+            monitor.run()
+            null_elapsed_times.append(time.monotonic() - run_start)
+            null_wall_times.append(monitor.wall_time())
+            if step_callback: step_callback()
+
+        # busy workload: harness-measured versus self-measured time
+        timing_biases: List[float] = []
+        for _ in range(runs):
+            monitor = rm.ResourceMonitor([busy_exe],
+                                         capture_policy="capture")
+            monitor.run()
+            # the workload reports its own nanoseconds on stderr
+            internal_seconds = int(monitor.stderr().strip()) / 1e9
+            timing_biases.append(monitor.wall_time() - internal_seconds)
+            if step_callback: step_callback()
+
+        # allocator workload: harness-measured versus touched RSS
+        rss_biases: List[float] = []
+        for _ in range(runs):
+            monitor = rm.ResourceMonitor([alloc_exe],
+                                         capture_policy="discard")
+            monitor.run()
+            rss_biases.append(monitor.max_memory()
+                              - _ALLOC_BYTES / 1024)
+            if step_callback: step_callback()
+
+    report = {
+        "timestamp": datetime.datetime.now().isoformat(timespec="seconds"),
+        "environment": opcore.environment_fingerprint(),
+        "runs": runs,
+        "timing_floor_s": min(null_wall_times),
+        "per_run_cost_s": statistics.mean(null_elapsed_times),
+        "timing_bias_s": statistics.mean(timing_biases),
+        "timing_bias_stdev_s": statistics.stdev(timing_biases),
+        "rss_bias_kb": statistics.mean(rss_biases),
+    }
+
+    if history_path is not None:
+        _append_history(history_path, report)
+
+    return report
+
+
+def self_benchmark_steps(runs: int) -> int:
+    """Returns the number of monitored runs of a self-benchmark.
+
+    Args:
+        runs: Number of monitored runs per workload.
+
+    Returns:
+        The total number of `step_callback` invocations
+        `run_self_benchmark` performs.
+    """
+
+    # three workloads, `runs` monitored runs each
+    return 3 * runs
+
+
+def load_last_history_report(history_path: str) -> Optional[Dict]:
+    """Loads the most recent report from a history file.
+
+    Args:
+        history_path: Path of the JSONL history file.
+
+    Returns:
+        The last recorded report, or None when the file does not exist
+        or contains no report.
+
+    Raises:
+        ValueError: If the history file is malformed.
+    """
+
+    if not os.path.isfile(history_path):
+        return None
+
+    last_report = None
+    with open(history_path) as f:
+        for line_number, line in enumerate(f, start=1):
+            line = line.strip()
+            if not line:
+                # ignore blank lines (e.g. a partial last line
+                # truncated away by a crash mid-write)
+                continue
+            try:
+                last_report = json.loads(line)
+            except ValueError:
+                raise ValueError(
+                    f"malformed self-benchmark history record"
+                    f" ('{history_path}', line {line_number})")
+
+    return last_report
+
+
+def _compile_workload(name: str, source: str, work_dir: str) -> str:
+    """Compiles one workload source into the working directory.
+
+    Args:
+        name: Short name of the workload (used for the file names).
+        source: The C source of the workload.
+        work_dir: Directory the source and the executable are placed
+            in.
+
+    Returns:
+        The path of the compiled executable.
+
+    Raises:
+        CalledProcessError: If the compilation fails.
+    """
+
+    source_path = os.path.join(work_dir, f"{name}.c")
+    exe_path = os.path.join(work_dir, name)
+    with open(source_path, 'w') as f:
+        f.write(source)
+
+    # -O0, so the calibrated workloads are not transformed (the busy
+    # loop in particular must execute its nominal iteration count)
+    monitor = rm.ResourceMonitor([ "gcc", "-O0", source_path,
+                                   "-o", exe_path ])
+    monitor.run()
+
+    return exe_path
+
+
+def _append_history(history_path: str, report: Dict) -> None:
+    """Appends a report to the history file.
+
+    The record is flushed and fsync'ed before returning, mirroring
+    `rs.ResultsStore`.
+
+    Args:
+        history_path: Path of the JSONL history file.
+        report: The report to append.
+
+    Raises:
+        OSError: If the history file cannot be written.
+    """
+
+    with open(history_path, 'a') as f:
+        f.write(json.dumps(report) + "\n")
+        f.flush()
+        os.fsync(f.fileno())